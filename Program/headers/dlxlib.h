@@ -0,0 +1,101 @@
+#ifndef DLXLIB_H
+#define DLXLIB_H
+
+////////// dlxlib ////////////////////////////////////////////////////////////
+// Автор    : Баталов Семен                                                 //
+// Дата     : 08.11.2020                                                    //
+// Описание : Здесь представлен решатель задачи точного покрытия            //
+//            (алгоритм X Кнута на "танцующих ссылках").                    //
+//////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace pcs
+{
+    ////////// class ExactCover //////////////////////////////////////////////
+    // Задача точного покрытия : есть столбцы и строки (наборы столбцов),   //
+    // нужно выбрать строки так, чтобы каждый основной столбец был покрыт   //
+    // ровно один раз, а каждый дополнительный - не более одного раза.      //
+    //                                                                      //
+    // 1) setColumns(...) : задает кол-во основных и дополнительных         //
+    //    столбцов (основные - первые), удаляет все строки.                 //
+    // 2) addRow(...)     : добавляет строку (номера строк идут по          //
+    //    порядку с 0).                                                     //
+    // 3) solve(...)      : ищет покрытие, ветвясь по основному столбцу с   //
+    //    наименьшим числом строк (MRV). Функция "isTimeUp" вызывается в    //
+    //    каждом узле перебора и может его прервать.                        //
+    //////////////////////////////////////////////////////////////////////////
+    
+    class ExactCover
+    {
+        private :
+            
+            std::vector<int32_t> left_;     // Соседний узел слева
+            std::vector<int32_t> right_;    // Соседний узел справа
+            std::vector<int32_t> up_;       // Соседний узел сверху
+            std::vector<int32_t> down_;     // Соседний узел снизу
+            std::vector<int32_t> column_;   // Столбец узла
+            std::vector<int32_t> row_;      // Строка узла
+            std::vector<int32_t> size_;     // Кол-во узлов в столбце
+            std::vector<int32_t> solution_; // Узлы выбранных строк
+            std::vector<int32_t> answer_;   // Строки найденного покрытия
+            int32_t nColumns_;              // Кол-во столбцов
+            int32_t nRows_;                 // Кол-во строк
+            int64_t nNodes_;                // Кол-во узлов перебора
+            bool    isInterrupted_;         // Перебор прерван
+            
+        public :
+            
+            // (1) Конструктор
+            ExactCover();
+            
+            // (2) Конструктор копирования
+            ExactCover(const ExactCover& cover) = default;
+            
+            // (3) Перегрузка оператора присваивания
+            ExactCover& operator=(const ExactCover& cover) = default;
+            
+            // (4) Задает столбцы (сначала основные, затем дополнительные)
+            void setColumns(int32_t nPrimary, int32_t nSecondary);
+            
+            // (5) Добавляет строку из столбцов "columns"
+            void addRow(const std::vector<int32_t>& columns);
+            
+            // (6) Ищет покрытие (номера строк - в "rows")
+            bool solve(std::vector<int32_t>& rows,
+                       const std::function<bool()>& isTimeUp);
+            
+            // (7) Перебор был прерван?
+            bool wasInterrupted() const;
+            
+            // (8) Возвращает кол-во узлов последнего перебора
+            int64_t getNodeNumber() const;
+            
+            // (9) Возвращает кол-во узлов матрицы (память)
+            int32_t getCellNumber() const;
+            
+            // (10) Освобождает выделенную память
+            void clear();
+            
+            // (11) Деструктор
+            ~ExactCover() = default;
+            
+        private :
+            
+            // (1) Убирает столбец "col" и все пересекающие его строки
+            void cover(int32_t col);
+            
+            // (2) Возвращает столбец "col" (обратно к "cover")
+            void uncover(int32_t col);
+            
+            // (3) Выбирает основной столбец с наименьшим числом строк
+            int32_t chooseColumn() const;
+            
+            // (4) Рекурсивный перебор (true - покрытие найдено)
+            bool search(const std::function<bool()>& isTimeUp);
+    };
+}
+
+#endif
\ No newline at end of file
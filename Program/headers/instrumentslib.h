@@ -9,10 +9,14 @@
 //////////////////////////////////////////////////////////////////////////////
 
 #include "errlib.h"
+#include "simdlib.h"
 
 #include <iostream>
 #include <vector>
 #include <cmath>
+#include <cstring>
+#include <new>
+#include <utility>
 
 // Символ индикатора
 #define INDICATE_SYMBOL '#'
@@ -41,9 +45,83 @@ namespace pcs
     const int16_t MAIN_REPLAY_NUMBER = 8000;
     const int16_t INDICATOR_NUMBER   = 100;
     
+    // Кол-во шагов блуждания между проверками флага остановки и срока
+    const int32_t WALK_CHECK_NUMBER  = 1024;
+    
+    // Ограничение времени систематического перебора (мс) и кол-во узлов
+    // перебора между проверками времени
+    const int32_t BACKTRACK_TIME_LIMIT   = 60000;
+    const int32_t BACKTRACK_CHECK_NUMBER = 1024;
+    
+    // Ограничения каталога путей точного покрытия : кол-во путей одной пары
+    // и общий размер матрицы (в узлах)
+    const int32_t COVER_PATH_LIMIT = 20000;
+    const int32_t COVER_CELL_LIMIT = 4000000;
+    
+    // Карты расстояний пар : плитки 2^DIST_TILE_SHIFT x 2^DIST_TILE_SHIFT
+    // (по ним отслеживаются изменения поля) и метка недостижимой клетки
+    const int16_t DIST_TILE_SHIFT  = 3;
+    const uint8_t DIST_UNREACHABLE = 255;
+    
+    // Штрафы конфликтов : множитель затухания (за одно удаление), порог
+    // перемасштабирования и длина списка запретов на удаление
+    const double  CONFLICT_DECAY = 0.95;
+    const double  CONFLICT_LIMIT = 1e100;
+    const int16_t TABU_LENGTH    = 8;
+    
+    // Перезапуски : базовое кол-во проходов без улучшения и множитель
+    // геометрической политики
+    const int32_t RESTART_BASE   = 2;
+    const double  RESTART_GROWTH = 1.5;
+    
+    // Порядок обхода "самые стесненные - первыми" : веса признаков (кол-во
+    // пар, запас длины пути, индекс, занятые соседи) и амплитуда случайной
+    // добавки, которая разбивает равенства (большие индексы первыми на
+    // Test_Fields только мешали, поэтому вес индекса нулевой)
+    const double  ORDER_PARTNER_WEIGHT = 1;
+    const double  ORDER_SLACK_WEIGHT   = 0.25;
+    const double  ORDER_INDEX_WEIGHT   = 0;
+    const double  ORDER_NEAR_WEIGHT    = 0.25;
+    const double  ORDER_NOISE          = 3;
+    
+    // Отжиг : температура MAX_T * exp(-ALPHA * step) до MIN_T, кол-во
+    // повторных нагревов и наибольшее кол-во путей, удаляемых за шаг
+    const double  ANNEAL_ALPHA         = 0.001;
+    const double  ANNEAL_MAX_T         = 20;
+    const double  ANNEAL_MIN_T         = 0.005;
+    const int16_t ANNEAL_STAGE_NUMBER  = 2;
+    const int16_t ANNEAL_DELETE_NUMBER = 16;
+    
+    // Повторяющиеся блоки : наименьший и наибольший размер стороны блока,
+    // кол-во размеров, для которых блоки проверяются точно, и множители
+    // двумерного полиномиального хэша (нечетные, поэтому обратимы по
+    // модулю 2^64)
+    const int16_t  BLOCK_MIN_SIZE     = MIN_SIZE_X;
+    const int16_t  BLOCK_MAX_SIZE     = 20;
+    const int32_t  BLOCK_CHECK_NUMBER = 8;
+    const uint64_t BLOCK_HASH_X       = 0x9E3779B97F4A7C15ULL;
+    const uint64_t BLOCK_HASH_Y       = 0xC2B2AE3D27D4EB4FULL;
+    
+    // Таблица перестановок : объем памяти по умолчанию (байт), кол-во
+    // записей в корзине и зерно ключей Зобриста (не зависит от зерна
+    // решателя, поэтому хэш одного состояния всегда одинаков)
+    const size_t   TABLE_MEMORY      = 16 << 20;
+    const int16_t  TABLE_BUCKET_SIZE = 4;
+    const uint64_t ZOBRIST_SEED      = 0x2545F4914F6CDD1DULL;
+    
+    // Выравнивание буфера плоскостей поля (размер строки кэша)
+    const size_t  CELLS_ALIGNMENT    = 64;
+    
+    // "id" клеток рамки ("стены") вокруг поля
+    const int16_t WALL_ID = -1;
+    
     // Перечисление направлений, нужных для ориентирования путей на поле
     enum Direction {LEFT, RIGHT, VERTICAL, MIDDLE, NONE};
     
+    // Сдвиги по "X" и "Y" для кодов шага 0..3 (влево, вправо, вверх, вниз)
+    const int16_t SHIFT_X[4] = {-1, 1, 0,  0};
+    const int16_t SHIFT_Y[4] = { 0, 0, 1, -1};
+    
     ////////// struct Vector /////////////////////////////////////////////////
     // Эта структура используется для представления местоположения точек    //
     // (клеток) на поле, для более удобной адресации в поле ячеек.          //
@@ -109,14 +187,117 @@ namespace pcs
     
     int16_t min(int16_t var1, int16_t var2);
     
+    ////////// temperature ///////////////////////////////////////////////////
+    // Температура отжига на шаге "step" (убывает экспоненциально,          //
+    // для отрицательного шага - 0).                                        //
+    //////////////////////////////////////////////////////////////////////////
+    
+    double temperature(int32_t step);
+    
+    ////////// class Random //////////////////////////////////////////////////
+    // Генератор псевдослучайных чисел xoshiro256** (собственное состояние  //
+    // у каждого объекта, поэтому независимые решатели не мешают друг       //
+    // другу). Начальное состояние получается из зерна через splitmix64,    //
+    // одинаковое зерно дает одинаковую последовательность.                 //
+    //////////////////////////////////////////////////////////////////////////
+    
+    class Random
+    {
+        private :
+            
+            uint64_t state_[4];     // Состояние генератора
+            
+        public :
+            
+            // (1) Конструктор (зерно по умолчанию)
+            Random();
+            
+            // (2) Конструктор от зерна
+            Random(uint64_t seed);
+            
+            // (3) Конструктор копирования
+            Random(const Random& random) = default;
+            
+            // (4) Перегрузка оператора присваивания
+            Random& operator=(const Random& random) = default;
+            
+            // (5) Задает зерно генератора
+            void setSeed(uint64_t seed);
+            
+            // (6) Возвращает очередное 64-битное число
+            uint64_t next();
+            
+            // (7) Возвращает случайное число из [0, range) (range > 0)
+            uint32_t uniform(uint32_t range);
+            
+            // (8) Возвращает случайное число из [0, 1)
+            double uniformReal();
+            
+            // (9) Деструктор
+            ~Random() = default;
+    };
+    
+    ////////// class TranspositionTable //////////////////////////////////////
+    // Таблица перестановок : множество 64-битных хэшей состояний с         //
+    // ограниченным объемом памяти. Записи лежат корзинами по               //
+    // TABLE_BUCKET_SIZE, при переполнении корзины вытесняется одна из ее   //
+    // записей (по старшим битам нового ключа). Ключ 0 означает пустую      //
+    // запись, поэтому он заменяется на 1. Ведет счетчики попаданий и       //
+    // промахов поиска. Таблица без памяти отключена : ничего не находит и  //
+    // не хранит.                                                           //
+    //////////////////////////////////////////////////////////////////////////
+    
+    class TranspositionTable
+    {
+        private :
+            
+            std::vector<uint64_t> keys_;    // Записи (0 - пусто)
+            size_t  mask_;                  // Маска номера корзины
+            int64_t nHits_;                 // Кол-во попаданий
+            int64_t nMisses_;               // Кол-во промахов
+            
+        public :
+            
+            // (1) Конструктор
+            TranspositionTable();
+            
+            // (2) Конструктор копирования
+            TranspositionTable(const TranspositionTable& table) = default;
+            
+            // (3) Перегрузка оператора присваивания
+            TranspositionTable& operator=(const TranspositionTable& table) =
+                default;
+            
+            // (4) Выделяет не более "memory" байт и очищает таблицу
+            void setMemory(size_t memory);
+            
+            // (5) Ключ есть в таблице? (считает попадания и промахи)
+            bool find(uint64_t key);
+            
+            // (6) Добавляет ключ
+            void insert(uint64_t key);
+            
+            // (7) Возвращает кол-во попаданий
+            int64_t getHitNumber() const;
+            
+            // (8) Возвращает кол-во промахов
+            int64_t getMissNumber() const;
+            
+            // (9) Освобождает выделенную память
+            void clear();
+            
+            // (10) Деструктор
+            ~TranspositionTable() = default;
+    };
+    
     ////////// createPermutation /////////////////////////////////////////////
     // Шаблонная процедура, которая производит случайную перестановку       //
-    // элементов вектора "array".                                           //
+    // элементов вектора "array", используя генератор "random".             //
     // Перегрузка с параметром "num" переставляет первые "num" элементов.   //
     //////////////////////////////////////////////////////////////////////////
     
     template <class T>
-    void createPermutation(std::vector<T>& array, int16_t num)
+    void createPermutation(std::vector<T>& array, int16_t num, Random& random)
     {
         // Если есть смысл производить перестановку
         if (num > 1 && num <= array.size())
@@ -127,7 +308,7 @@ namespace pcs
             // Создаем случайную перестановку первых "num" элементов
             for (int16_t i = num - 1; i > 0; --i)
             {
-                pos        = rand() % (i + 1);
+                pos        = random.uniform(i + 1);
                 temp       = array[i];
                 array[i]   = array[pos];
                 array[pos] = temp;
@@ -136,7 +317,7 @@ namespace pcs
     }
     
     template <class T>
-    void createPermutation(std::vector<T>& array)
+    void createPermutation(std::vector<T>& array, Random& random)
     {
         T       temp;
         int16_t pos = 0;
@@ -144,7 +325,7 @@ namespace pcs
         // Создаем случайную перестановку всех элементов
         for (int16_t i = array.size() - 1; i > 0; --i)
         {
-            pos        = rand() % (i + 1);
+            pos        = random.uniform(i + 1);
             temp       = array[i];
             array[i]   = array[pos];
             array[pos] = temp;
@@ -187,9 +368,88 @@ namespace pcs
             ~Cell() = default;
     };
     
+    ////////// class WayRef //////////////////////////////////////////////////
+    // Ссылка на элемент плоскости направлений поля. Позволяет читать и     //
+    // записывать направление "Direction", хранящееся в одном байте.        //
+    //////////////////////////////////////////////////////////////////////////
+    
+    class WayRef
+    {
+        private :
+            
+            int8_t& way_;   // Элемент плоскости направлений
+            
+        public :
+            
+            // (1) Конструктор (от элемента плоскости)
+            WayRef(int8_t& way);
+            
+            // (2) Конструктор копирования
+            WayRef(const WayRef& wayRef) = default;
+            
+            // (3) Перегрузка оператора присваивания (значения)
+            WayRef& operator=(const WayRef& wayRef);
+            
+            // (4) Перегрузка оператора присваивания (направления)
+            WayRef& operator=(Direction way);
+            
+            // (5) Приведение к направлению
+            operator Direction() const;
+            
+            // (6) Деструктор
+            ~WayRef() = default;
+    };
+    
+    ////////// struct CellRef ////////////////////////////////////////////////
+    // Совместимое с "Cell" представление клетки поля, которое хранится по  //
+    // плоскостям. Члены структуры ссылаются на элементы плоскостей, так    //
+    // что запись вида "field(x, y).id = ..." изменяет само поле.           //
+    //////////////////////////////////////////////////////////////////////////
+    
+    struct CellRef
+    {
+        public :
+            
+            int16_t&      index;    // Значение в данной клетке
+            int16_t&      id;       // ID пути, которым занята ячейка
+            int16_t&      num;      // Порядковый номер в пути
+            const int16_t protoId;  // "id" пути с началом в этой клетке
+            WayRef        way;      // Направление движения в клетке
+            
+        public :
+            
+            // (1) Конструктор (от элементов плоскостей)
+            CellRef(int16_t& newIndex, int16_t& newId, int16_t& newNum,
+                    int16_t newProtoId, int8_t& newWay);
+            
+            // (2) Конструктор копирования
+            CellRef(const CellRef& cell) = default;
+            
+            // (3) Перегрузка оператора присваивания (значений клетки)
+            CellRef& operator=(const CellRef& cell);
+            
+            // (4) Перегрузка оператора присваивания (от "Cell")
+            CellRef& operator=(const Cell& cell);
+            
+            // (5) Приведение к "Cell" (копия значений)
+            operator Cell() const;
+            
+            // (6) Деструктор
+            ~CellRef() = default;
+    };
+    
     ////////// class Field ///////////////////////////////////////////////////
     // Класс, описывающий игровое поле кроссворда (содержит информацию о    //
-    // всех ячейках).                                                       //
+    // всех ячейках). Поле хранится по плоскостям ("index", "id", "num",    //
+    // "way") в одном непрерывном выровненном буфере. Каждая плоскость      //
+    // окружена рамкой шириной в одну клетку ("стеной" с id = WALL_ID),     //
+    // поэтому клетка (x, y) лежит по смещению (y + 1) * stride_ + x + 1,   //
+    // где stride_ = sizeX_ + 2, а соседние клетки - по смещениям           //
+    // getShift(0..3). Длина плоскости дополнена нулями до кратной          //
+    // simd::PLANE_STEP. "protoId" не хранится, а вычисляется.              //
+    //                                                                      //
+    // Методы "...At(pos)" не проверяют выход за границы (проверка          //
+    // включается макросом PCS_DEBUG), оператор () проверяет всегда.        //
     //                                                                      //
     // В общем случае :                                                     //
     // 1) MIN_SIZE_X <= sizeX_ <= MAX_SIZE_X                                //
@@ -200,9 +460,15 @@ namespace pcs
     {
         private :
             
-            Cell**  cells_;     // Массив клеток - поле кроссворда
-            int16_t sizeX_;     // Размер поля по "X"
-            int16_t sizeY_;     // Размер поля по "Y"
+            int16_t* index_;    // Плоскость значений клеток (начало буфера)
+            int16_t* id_;       // Плоскость "id" путей
+            int16_t* num_;      // Плоскость порядковых номеров в пути
+            int8_t*  way_;      // Плоскость направлений
+            int32_t  length_;   // Длина каждой плоскости (с дополнением)
+            int32_t  shift_[4]; // Смещения соседних клеток в плоскости
+            int16_t  stride_;   // Длина строки плоскости (с рамкой)
+            int16_t  sizeX_;    // Размер поля по "X"
+            int16_t  sizeY_;    // Размер поля по "Y"
             
         public :
             
@@ -215,67 +481,223 @@ namespace pcs
             // (3) Перегрузка оператора присваивания
             Field& operator=(const Field& field);
             
-            // (4) Изменяет размер поля, уничтожая имеющуюся информацию
+            // (4) Конструктор перемещения
+            Field(Field&& field) noexcept;
+            
+            // (5) Перегрузка оператора перемещающего присваивания
+            Field& operator=(Field&& field) noexcept;
+            
+            // (6) Изменяет размер поля, уничтожая имеющуюся информацию
             void resize(int16_t sizeX, int16_t sizeY);
             
-            // (5) Перегрузка оператора ()
-            Cell& operator()(int16_t x, int16_t y);
+            // (7) Перегрузка оператора ()
+            CellRef operator()(int16_t x, int16_t y);
             
-            // (6) Перегрузка оператора ()
-            const Cell& operator()(int16_t x, int16_t y) const;
+            // (8) Перегрузка оператора ()
+            Cell operator()(int16_t x, int16_t y) const;
             
-            // (7) Перегрузка оператора () (через Vector)
-            Cell& operator()(Vector point);
+            // (9) Перегрузка оператора () (через Vector)
+            CellRef operator()(Vector point);
             
-            // (8) Перегрузка оператора () (через Vector)
-            const Cell& operator()(Vector point) const;
+            // (10) Перегрузка оператора () (через Vector)
+            Cell operator()(Vector point) const;
             
-            // (9) Возвращает размер по "X"
+            // (11) Возвращает размер по "X"
             int16_t getSizeX() const;
             
-            // (10) Возвращает размер по "Y"
+            // (12) Возвращает размер по "Y"
             int16_t getSizeY() const;
             
-            // (11) Проверяет поле на отсутствие индексов
+            // (13) Проверяет поле на отсутствие индексов
             bool isEmpty() const;
             
-            // (12) Проверяет соответствие размеров поля
+            // (14) Проверяет соответствие размеров поля
             bool isCorrectSize() const;
             
-            // (13) Проверяет корректность задания индексов
+            // (15) Проверяет корректность задания индексов
             bool isCorrectIndex() const;
             
-            // (14) Оставляет индексы и обнуляет все остальное
+            // (16) Оставляет индексы и обнуляет все остальное
             void refresh();
             
-            // (15) "true" если не выходим за границу
+            // (17) "true" если не выходим за границу
             bool inRange(int16_t x, int16_t y) const;
             
-            // (16) "true" если не выходим за границу (через Vector)
+            // (18) "true" если не выходим за границу (через Vector)
             bool inRange(Vector point) const;
             
-            // (17) Освобождает выделенную память
+            // (19) Возвращает длину плоскостей (с дополнением)
+            int32_t getPlaneLength() const;
+            
+            // (20) Плоскость значений клеток
+            const int16_t* getIndexPlane() const;
+            
+            // (21) Плоскость "id" путей
+            const int16_t* getIdPlane() const;
+            
+            // (22) Плоскость порядковых номеров в пути
+            const int16_t* getNumPlane() const;
+            
+            // (23) Смещение клетки (x, y) в плоскостях
+            int32_t getPos(int16_t x, int16_t y) const;
+            
+            // (24) Смещение клетки "point" в плоскостях
+            int32_t getPos(Vector point) const;
+            
+            // (25) Смещение соседней клетки для кода шага "dir" (0..3)
+            int32_t getShift(int16_t dir) const;
+            
+            // (26) Значение клетки по смещению (без проверки)
+            int16_t& indexAt(int32_t pos);
+            
+            // (27) Значение клетки по смещению (без проверки)
+            int16_t indexAt(int32_t pos) const;
+            
+            // (28) "id" пути клетки по смещению (без проверки)
+            int16_t& idAt(int32_t pos);
+            
+            // (29) "id" пути клетки по смещению (без проверки)
+            int16_t idAt(int32_t pos) const;
+            
+            // (30) Номер в пути клетки по смещению (без проверки)
+            int16_t& numAt(int32_t pos);
+            
+            // (31) Номер в пути клетки по смещению (без проверки)
+            int16_t numAt(int32_t pos) const;
+            
+            // (32) Задает направление клетки по смещению (без проверки)
+            void setWayAt(int32_t pos, Direction way);
+            
+            // (33) Освобождает выделенную память
             void clear();
             
-            // (14) Деструктор
+            // (34) Деструктор
             ~Field();
+            
+        private :
+            
+            // (1) Проверка смещения (только при PCS_DEBUG)
+            void checkPos(int32_t pos) const;
+            
+            // (2) Заполняет рамку поля "стеной"
+            void buildWalls();
     };
     
+    ////////// Field : методы доступа без проверки ///////////////////////////
+    // Вызываются на каждом шаге построения пути, поэтому определены здесь. //
+    //////////////////////////////////////////////////////////////////////////
+    
+    // (1) Проверка смещения (только при PCS_DEBUG)
+    inline void Field::checkPos(int32_t pos) const
+    {
+#ifdef PCS_DEBUG
+        if (pos < 0 || pos >= length_)
+        {
+            throw err::PcsException(0);
+        }
+#else
+        (void) pos;
+#endif
+    }
+    
+    // (23) Смещение клетки (x, y) в плоскостях
+    inline int32_t Field::getPos(int16_t x, int16_t y) const
+    {
+        return (y + 1) * stride_ + x + 1;
+    }
+    
+    // (24) Смещение клетки "point" в плоскостях
+    inline int32_t Field::getPos(Vector point) const
+    {
+        return (point.y + 1) * stride_ + point.x + 1;
+    }
+    
+    // (25) Смещение соседней клетки для кода шага "dir" (0..3)
+    inline int32_t Field::getShift(int16_t dir) const
+    {
+        return shift_[dir];
+    }
+    
+    // (26) Значение клетки по смещению (без проверки)
+    inline int16_t& Field::indexAt(int32_t pos)
+    {
+        checkPos(pos);
+        return index_[pos];
+    }
+    
+    // (27) Значение клетки по смещению (без проверки)
+    inline int16_t Field::indexAt(int32_t pos) const
+    {
+        checkPos(pos);
+        return index_[pos];
+    }
+    
+    // (28) "id" пути клетки по смещению (без проверки)
+    inline int16_t& Field::idAt(int32_t pos)
+    {
+        checkPos(pos);
+        return id_[pos];
+    }
+    
+    // (29) "id" пути клетки по смещению (без проверки)
+    inline int16_t Field::idAt(int32_t pos) const
+    {
+        checkPos(pos);
+        return id_[pos];
+    }
+    
+    // (30) Номер в пути клетки по смещению (без проверки)
+    inline int16_t& Field::numAt(int32_t pos)
+    {
+        checkPos(pos);
+        return num_[pos];
+    }
+    
+    // (31) Номер в пути клетки по смещению (без проверки)
+    inline int16_t Field::numAt(int32_t pos) const
+    {
+        checkPos(pos);
+        return num_[pos];
+    }
+    
+    // (32) Задает направление клетки по смещению (без проверки)
+    inline void Field::setWayAt(int32_t pos, Direction way)
+    {
+        checkPos(pos);
+        way_[pos] = static_cast<int8_t> (way);
+    }
+    
     ////////// class TrackSeq ////////////////////////////////////////////////
     // Объект класса генерирует в себе случайную последовательность сдвигов //
     // на поле относительно заданной точки (Влево, Вправо, Вверх, Вниз).    //
+    // Последовательность - одна из 24 перестановок кодов {0, 1, 2, 3} из   //
+    // таблицы TRACK_PERMUTATIONS, поэтому состояние объекта - номер        //
+    // перестановки и номер шага в ней.                                     //
     //                                                                      //
-    // 1) regenerate()   : сгенерировать случайную последовательность.      //
-    // 2) getVector(...) : запросить очередной случайный сдвиг.             //
-    // 3) haveFinished() : проверить, все ли возможные сдвиги использованы. //
+    // 1) regenerate(...) : сгенерировать случайную последовательность.     //
+    // 2) getVector(...)  : запросить очередной случайный сдвиг.            //
+    //    getShiftCode()  : то же, но в виде кода сдвига 0..3.              //
+    // 3) haveFinished()  : проверить, все ли возможные сдвиги              //
+    //    использованы.                                                     //
     //////////////////////////////////////////////////////////////////////////
     
+    // Все перестановки кодов сдвигов {0, 1, 2, 3}
+    const int8_t TRACK_PERMUTATIONS[24][4] =
+    {
+        {0, 1, 2, 3}, {0, 1, 3, 2}, {0, 2, 1, 3}, {0, 2, 3, 1},
+        {0, 3, 1, 2}, {0, 3, 2, 1}, {1, 0, 2, 3}, {1, 0, 3, 2},
+        {1, 2, 0, 3}, {1, 2, 3, 0}, {1, 3, 0, 2}, {1, 3, 2, 0},
+        {2, 0, 1, 3}, {2, 0, 3, 1}, {2, 1, 0, 3}, {2, 1, 3, 0},
+        {2, 3, 0, 1}, {2, 3, 1, 0}, {3, 0, 1, 2}, {3, 0, 2, 1},
+        {3, 1, 0, 2}, {3, 1, 2, 0}, {3, 2, 0, 1}, {3, 2, 1, 0}
+    };
+    
     class TrackSeq
     {
         private :
             
-            std::vector<int16_t> seq_;      // Случайная последовательность
-            int16_t              number_;   // Номер шага
+            uint8_t perm_;      // Номер перестановки в TRACK_PERMUTATIONS
+            uint8_t number_;    // Номер шага
             
         public :
             
@@ -289,7 +711,7 @@ namespace pcs
             TrackSeq& operator=(const TrackSeq& sequence) = default;
             
             // (4) Сгенерировать новую случайную последовательность
-            void regenerate();
+            void regenerate(Random& random);
             
             // (5) Возвращает "true", если использовали все варианты сдвига
             bool haveFinished() const;
@@ -300,13 +722,43 @@ namespace pcs
             // (7) Вернуть позицию после очередного сдвига
             Vector getVector(int16_t x, int16_t y);
             
-            // (8) Обнуляет поля, освобождает выделенную память
+            // (8) Вернуть код очередного сдвига (см. SHIFT_X, SHIFT_Y)
+            int16_t getShiftCode();
+            
+            // (9) Обнуляет поля
             void clear();
             
-            // (9) Деструктор
+            // (10) Деструктор
             ~TrackSeq() = default;
     };
     
+    ////////// TrackSeq : встраиваемые методы ////////////////////////////////
+    // Вызываются на каждом шаге построения пути, поэтому определены здесь. //
+    //////////////////////////////////////////////////////////////////////////
+    
+    // (4) Сгенерировать новую случайную последовательность
+    inline void TrackSeq::regenerate(Random& random)
+    {
+        perm_   = random.uniform(24);
+        number_ = 0;
+    }
+    
+    // (5) Возвращает "true", если использовали все варианты сдвига
+    inline bool TrackSeq::haveFinished() const
+    {
+        return number_ >= 4;
+    }
+    
+    // (8) Вернуть код очередного сдвига (см. SHIFT_X, SHIFT_Y)
+    inline int16_t TrackSeq::getShiftCode()
+    {
+        if (number_ >= 4)
+        {
+            throw err::PcsException(1);
+        }
+        return TRACK_PERMUTATIONS[perm_][number_++];
+    }
+    
     ////////// struct Area ///////////////////////////////////////////////////
     // Структура описывает прямоугольую область на поле "Field".            //
     // Используется в основном для ограничения зоны действия алгоритма      //
@@ -348,6 +800,69 @@ namespace pcs
             // (8) Деструктор
             ~Area() = default;
     };
+    
+    ////////// struct Region /////////////////////////////////////////////////
+    // Структура описывает область произвольной формы на поле "Field" :     //
+    // описанный прямоугольник "box" и для каждой его строки отрезок        //
+    // [minX, maxX] (для пустой строки minX > maxX). Используется для       //
+    // точной рабочей области пары - клеток, через которые может пройти     //
+    // путь нужной длины.                                                   //
+    //////////////////////////////////////////////////////////////////////////
+    
+    struct Region
+    {
+        public :
+            
+            Area                 box;   // Описанный прямоугольник
+            std::vector<int16_t> minX;  // Левая граница строки (от box.minY)
+            std::vector<int16_t> maxX;  // Правая граница строки
+            
+        public :
+            
+            // (1) Конструктор
+            Region() = default;
+            
+            // (2) Конструктор копирования
+            Region(const Region& newRegion) = default;
+            
+            // (3) Перегрузка оператора присваивания
+            Region& operator=(const Region& newRegion) = default;
+            
+            // (4) Проверка попадания точки "point" в область
+            bool inRange(Vector point) const;
+            
+            // (5) Проверка попадания точки (x, y) в область
+            bool inRange(int16_t x, int16_t y) const;
+            
+            // (6) Проверка корректности области
+            bool isCorrect() const;
+            
+            // (7) Возвращает кол-во клеток области
+            int32_t getCellNumber() const;
+            
+            // (8) Обнуляет поля, освобождает выделенную память
+            void clear();
+            
+            // (9) Деструктор
+            ~Region() = default;
+    };
+    
+    ////////// Region : проверка попадания ///////////////////////////////////
+    // Вызывается на каждом шаге построения пути, поэтому определена здесь. //
+    //////////////////////////////////////////////////////////////////////////
+    
+    // (4) Проверка попадания точки "point" в область
+    inline bool Region::inRange(Vector point) const
+    {
+        return inRange(point.x, point.y);
+    }
+    
+    // (5) Проверка попадания точки (x, y) в область
+    inline bool Region::inRange(int16_t x, int16_t y) const
+    {
+        return box.inRange(x, y) && x >= minX[y - box.minY] &&
+                                    x <= maxX[y - box.minY];
+    }
 }
 
 #endif
\ No newline at end of file
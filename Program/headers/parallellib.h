@@ -0,0 +1,378 @@
+#ifndef PARALLELLIB_H
+#define PARALLELLIB_H
+
+////////// parallellib ///////////////////////////////////////////////////////
+// Автор    : Баталов Семен                                                 //
+// Дата     : 08.11.2020                                                    //
+// Описание : Здесь представлены инструменты для параллельного решения      //
+//            филиппинского кроссворда (пул потоков, "портфель"             //
+//            независимых решателей, решение по частям и по повторяющимся   //
+//            блокам, пакетное решение набора полей).                       //
+//////////////////////////////////////////////////////////////////////////////
+
+#include "errlib.h"
+#include "instrumentslib.h"
+#include "solvelib.h"
+#include "rwconfig.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+
+namespace pcs
+{
+    ////////// getCoreNumber /////////////////////////////////////////////////
+    // Возвращает кол-во доступных ядер процессора (не меньше 1).           //
+    //////////////////////////////////////////////////////////////////////////
+    
+    int16_t getCoreNumber();
+    
+    ////////// class ThreadPool //////////////////////////////////////////////
+    // Пул из фиксированного числа потоков, выполняющих задачи из общей     //
+    // очереди.                                                             //
+    //                                                                      //
+    // 1) submit(...) : поставить задачу в очередь.                         //
+    // 2) wait()      : дождаться выполнения всех задач. Если задача        //
+    //    выбросила исключение, то первое из них выбрасывается повторно.    //
+    //////////////////////////////////////////////////////////////////////////
+    
+    class ThreadPool
+    {
+        private :
+            
+            std::vector<std::thread>          workers_;   // Потоки пула
+            std::queue<std::function<void()>> tasks_;     // Очередь задач
+            std::mutex                        mutex_;     // Защита очереди
+            std::condition_variable           haveTask_;  // Появилась задача
+            std::condition_variable           haveDone_;  // Задачи выполнены
+            std::exception_ptr                error_;     // Первое исключение
+            int32_t                           nActive_;   // Задач в работе
+            bool                              isStopped_; // Пул закрывается
+            
+        public :
+            
+            // (1) Конструктор (запускает "nThreads" потоков)
+            ThreadPool(int16_t nThreads);
+            
+            // (2) Конструктор копирования (запрещен)
+            ThreadPool(const ThreadPool& pool) = delete;
+            
+            // (3) Перегрузка оператора присваивания (запрещена)
+            ThreadPool& operator=(const ThreadPool& pool) = delete;
+            
+            // (4) Ставит задачу в очередь
+            void submit(std::function<void()> task);
+            
+            // (5) Ждет выполнения всех задач
+            void wait();
+            
+            // (6) Возвращает кол-во потоков
+            int16_t getThreadNumber() const;
+            
+            // (7) Деструктор (дожидается потоков)
+            ~ThreadPool();
+            
+        private :
+            
+            // (1) Цикл работы потока
+            void work();
+    };
+    
+    ////////// class Portfolio ///////////////////////////////////////////////
+    // "Портфель" решателей : на пуле потоков запускается несколько         //
+    // независимых объектов "Solver" с разными зернами. Как только один из  //
+    // них разводит все пути, остальные останавливаются, а его решение      //
+    // становится результатом.                                              //
+    //                                                                      //
+    // 1) setThreadNumber(...) : кол-во решателей (по умолчанию - кол-во    //
+    //    ядер).                                                            //
+    // 2) setSeed(...)         : зерно; решатель номер "k" получает         //
+    //    зерно "seed + k".                                                 //
+    // 3) setPrototype(...)    : решатель - образец настроек (движок,       //
+    //    лимиты, перезапуски, порядок обхода, статистика) для всех         //
+    //    решателей портфеля.                                               //
+    // 4) setProgress(...)     : обработчик хода решения; его вызывает      //
+    //    только решатель номер 0 (из своего потока).                       //
+    // 5) solve(...)           : решает корректное поле "field".            //
+    // 6) getField(...)        : копирует решение (с направлениями).        //
+    // 7) getStatus()          : итог решения (SOLVED, если кто-то решил).  //
+    // 8) getStats()           : сумма статистик всех решателей (сбор       //
+    //    включается у образца - "Solver::setStats").                       //
+    //////////////////////////////////////////////////////////////////////////
+    
+    class Portfolio
+    {
+        private :
+            
+            Solver            proto_;       // Образец настроек решателя
+            Field             result_;      // Поле первого решения
+            std::atomic<bool> stop_;        // Флаг остановки решателей
+            std::mutex        mutex_;       // Защита результата
+            std::function<void(int32_t, int16_t)> progress_; // Ход решения
+            SolverStats       stats_;       // Сумма статистик решателей
+            uint64_t          seed_;        // Базовое зерно
+            uint64_t          winnerSeed_;  // Зерно решившего решателя
+            SolveStatus       status_;      // Итог решения
+            int16_t           nThreads_;    // Кол-во решателей
+            
+        public :
+            
+            // (1) Конструктор
+            Portfolio();
+            
+            // (2) Конструктор копирования (запрещен)
+            Portfolio(const Portfolio& portfolio) = delete;
+            
+            // (3) Перегрузка оператора присваивания (запрещена)
+            Portfolio& operator=(const Portfolio& portfolio) = delete;
+            
+            // (4) Задает кол-во решателей
+            void setThreadNumber(int16_t nThreads);
+            
+            // (5) Задает базовое зерно
+            void setSeed(uint64_t seed);
+            
+            // (6) Задает решатель - образец настроек
+            void setPrototype(const Solver& solver);
+            
+            // (7) Задает обработчик хода решения (пустой - без индикации)
+            void setProgress(const std::function<void(int32_t, int16_t)>&
+                             progress);
+            
+            // (8) Решает поле "field" (если это удается)
+            void solve(const Field& field, bool& wasSolved);
+            
+            // (9) Копирует решение в "field"
+            void getField(Field& field) const;
+            
+            // (10) Возвращает зерно решателя, нашедшего решение
+            uint64_t getWinnerSeed() const;
+            
+            // (11) Возвращает итог решения
+            SolveStatus getStatus() const;
+            
+            // (12) Возвращает сумму статистик решателей
+            const SolverStats& getStats() const;
+            
+            // (13) Деструктор
+            ~Portfolio() = default;
+    };
+    
+    ////////// class Decomposer //////////////////////////////////////////////
+    // Решение поля по независимым частям (см. "Solver::splitField") :      //
+    // каждая часть решается своим объектом "Solver" на пуле потоков, а     //
+    // решения сливаются в одно поле. Перезапуск в одной части не           //
+    // разрушает пути других, а части распределяются по ядрам.              //
+    //                                                                      //
+    // 1) setThreadNumber(...) : кол-во потоков (по умолчанию - кол-во      //
+    //    ядер).                                                            //
+    // 2) setSeed(...)         : зерно; часть номер "k" получает зерно      //
+    //    "seed + k".                                                       //
+    // 3) split(...)           : разбивает поле решателя (поле уже          //
+    //    проверено "isCorrectField"). Решатель служит образцом настроек    //
+    //    (движок, лимиты, перезапуски) для решателей частей; ход решения   //
+    //    части не сообщают (их решают параллельно).                        //
+    // 4) solve(...)           : решает все части; если одна часть не       //
+    //    решилась, остальные останавливаются.                              //
+    // 5) getField(...)        : копирует слитое решение (с направлениями). //
+    // 6) getStats()           : сумма статистик решателей частей (сбор     //
+    //    включается у образца - "Solver::setStats").                       //
+    //////////////////////////////////////////////////////////////////////////
+    
+    class Decomposer
+    {
+        private :
+            
+            Solver             proto_;      // Образец настроек решателя
+            std::vector<Field> parts_;      // Независимые части поля
+            Field              result_;     // Слитое решение
+            std::atomic<bool>  stop_;       // Флаг остановки решателей
+            std::mutex         mutex_;      // Защита результата
+            SolverStats        stats_;      // Сумма статистик решателей
+            uint64_t           seed_;       // Базовое зерно
+            SolveStatus        status_;     // Итог (худший по частям)
+            int16_t            nThreads_;   // Кол-во потоков
+            
+        public :
+            
+            // (1) Конструктор
+            Decomposer();
+            
+            // (2) Конструктор копирования (запрещен)
+            Decomposer(const Decomposer& decomposer) = delete;
+            
+            // (3) Перегрузка оператора присваивания (запрещена)
+            Decomposer& operator=(const Decomposer& decomposer) = delete;
+            
+            // (4) Задает кол-во потоков
+            void setThreadNumber(int16_t nThreads);
+            
+            // (5) Задает базовое зерно
+            void setSeed(uint64_t seed);
+            
+            // (6) Разбивает поле решателя "solver" на части
+            void split(const Solver& solver);
+            
+            // (7) Возвращает кол-во частей
+            int16_t getPartNumber() const;
+            
+            // (8) Решает все части (если это удается)
+            void solve(bool& wasSolved);
+            
+            // (9) Копирует слитое решение в "field"
+            void getField(Field& field) const;
+            
+            // (10) Возвращает итог решения (худший по частям)
+            SolveStatus getStatus() const;
+            
+            // (11) Возвращает сумму статистик решателей частей
+            const SolverStats& getStats() const;
+            
+            // (12) Деструктор
+            ~Decomposer() = default;
+            
+        private :
+            
+            // (1) Переносит пути решенной части "part" в "result_"
+            void merge(const Field& part);
+    };
+    
+    ////////// class Stamper /////////////////////////////////////////////////
+    // Решение поля с повторяющимися блоками (см. "Solver::findBlocks") :   //
+    // каждый различный блок решается один раз (отдельно, стены вокруг      //
+    // блока), его пути впечатываются во все копии. Клетки путей копий      //
+    // становятся единицами, и остаток поля решается обычным решателем.     //
+    // Если остаток не решился (впечатанные пути могли ему помешать), то    //
+    // решение не найдено, и поле нужно решать целиком.                     //
+    //                                                                      //
+    // 1) setThreadNumber(...) : кол-во потоков для решения блоков.         //
+    // 2) setSeed(...)         : зерно; блок номер "k" получает зерно       //
+    //    "seed + k", остаток - "seed + кол-во блоков".                     //
+    // 3) split(...)           : ищет блоки поля решателя (поле уже         //
+    //    проверено "isCorrectField"). Решатель - образец настроек; ход     //
+    //    решения сообщает только решатель остатка.                         //
+    // 4) solve(...)           : решает блоки и остаток.                    //
+    // 5) getField(...)        : копирует решение (с направлениями).        //
+    // 6) getStats()           : сумма статистик решателей блоков и         //
+    //    остатка (сбор включается у образца - "Solver::setStats").         //
+    //////////////////////////////////////////////////////////////////////////
+    
+    class Stamper
+    {
+        private :
+            
+            Solver             proto_;      // Образец настроек решателя
+            std::vector<Field> blocks_;     // Различные блоки (и решения)
+            std::vector<std::vector<Vector>> copies_; // Углы копий блоков
+            std::vector<uint8_t> isSolved_; // Блок решен
+            Field              source_;     // Исходное поле
+            Field              result_;     // Решение
+            SolverStats        stats_;      // Сумма статистик решателей
+            std::mutex         mutex_;      // Защита статистики
+            uint64_t           seed_;       // Базовое зерно
+            SolveStatus        status_;     // Итог решения остатка
+            int16_t            nThreads_;   // Кол-во потоков
+            
+        public :
+            
+            // (1) Конструктор
+            Stamper();
+            
+            // (2) Конструктор копирования (запрещен)
+            Stamper(const Stamper& stamper) = delete;
+            
+            // (3) Перегрузка оператора присваивания (запрещена)
+            Stamper& operator=(const Stamper& stamper) = delete;
+            
+            // (4) Задает кол-во потоков
+            void setThreadNumber(int16_t nThreads);
+            
+            // (5) Задает базовое зерно
+            void setSeed(uint64_t seed);
+            
+            // (6) Ищет повторяющиеся блоки поля решателя "solver"
+            void split(const Solver& solver);
+            
+            // (7) Возвращает кол-во различных блоков
+            int16_t getBlockNumber() const;
+            
+            // (8) Возвращает кол-во копий всех блоков
+            int32_t getCopyNumber() const;
+            
+            // (9) Решает блоки и остаток поля (если это удается)
+            void solve(bool& wasSolved);
+            
+            // (10) Копирует решение в "field"
+            void getField(Field& field) const;
+            
+            // (11) Возвращает итог решения
+            SolveStatus getStatus() const;
+            
+            // (12) Возвращает сумму статистик решателей блоков и остатка
+            const SolverStats& getStats() const;
+            
+            // (13) Деструктор
+            ~Stamper() = default;
+            
+        private :
+            
+            // (1) Впечатывает решение блока "block" в копию с углом "corner"
+            void stamp(int16_t block, Vector corner);
+    };
+    
+    ////////// struct BatchTask //////////////////////////////////////////////
+    // Описывает одно поле пакетного решения: входной и выходной файлы и    //
+    // итог решения (заполняется процедурой "solveBatch").                  //
+    //////////////////////////////////////////////////////////////////////////
+    
+    struct BatchTask
+    {
+        public :
+            
+            std::string inName;     // Имя входного файла
+            std::string outName;    // Имя выходного файла
+            std::string error;      // Сообщение об ошибке (если была)
+            bool        isCorrect;  // Поле прочитано и задано корректно
+            bool        wasSolved;  // Поле решено
+            float       time;       // Время решения (сек)
+            int32_t     sweeps;     // Кол-во проходов решателя
+            int32_t     restarts;   // Кол-во перезапусков решателя
+            
+        public :
+            
+            // (1) Конструктор (обнуляет поля)
+            BatchTask();
+            
+            // (2) Конструктор копирования
+            BatchTask(const BatchTask& task) = default;
+            
+            // (3) Перегрузка оператора присваивания
+            BatchTask& operator=(const BatchTask& task) = default;
+            
+            // (4) Обнуляет итог решения
+            void clear();
+            
+            // (5) Деструктор
+            ~BatchTask() = default;
+    };
+    
+    ////////// solveBatch ////////////////////////////////////////////////////
+    // Решает поля из файлов "tasks[k].inName" на пуле из "nThreads"        //
+    // потоков и записывает решения в "tasks[k].outName". Каждый поток      //
+    // держит свою копию образца "proto" (движок, лимиты, перезапуски,      //
+    // порядок обхода) и использует ее для всех своих полей. Ход решения    //
+    // потоки не сообщают.                                                  //
+    // Все поля решаются с одним зерном "seed" (результат не зависит от     //
+    // распределения полей по потокам).                                     //
+    //////////////////////////////////////////////////////////////////////////
+    
+    void solveBatch(std::vector<BatchTask>& tasks, const Solver& proto,
+                    int16_t nThreads, uint64_t seed);
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef SIMDLIB_H
+#define SIMDLIB_H
+
+////////// simdlib ///////////////////////////////////////////////////////////
+// Автор    : Баталов Семен                                                 //
+// Дата     : 08.11.2020                                                    //
+// Описание : Здесь представлены векторные (SSE2/AVX2) процедуры просмотра  //
+//            плоскостей поля кроссворда. Если набор инструкций недоступен, //
+//            используется скалярная реализация.                            //
+//////////////////////////////////////////////////////////////////////////////
+
+#include <cstdint>
+
+namespace simd
+{
+    // Кол-во элементов "int16_t", кратно которому дополняются плоскости
+    const int32_t PLANE_STEP = 32;
+    
+    ////////// anyNonZero ////////////////////////////////////////////////////
+    // Возвращает "true", если среди первых "n" элементов плоскости "plane" //
+    // есть ненулевой.                                                      //
+    //////////////////////////////////////////////////////////////////////////
+    
+    bool anyNonZero(const int16_t* plane, int32_t n);
+    
+    ////////// allInRange ////////////////////////////////////////////////////
+    // Возвращает "true", если все первые "n" элементов плоскости "plane"   //
+    // лежат в отрезке [low, high].                                         //
+    //////////////////////////////////////////////////////////////////////////
+    
+    bool allInRange(const int16_t* plane, int32_t n, int16_t low, int16_t high);
+    
+    ////////// countFree /////////////////////////////////////////////////////
+    // Возвращает кол-во позиций среди первых "n", в которых                //
+    // index[k] > "threshold" и id[k] == 0.                                 //
+    //////////////////////////////////////////////////////////////////////////
+    
+    int32_t countFree(const int16_t* index, const int16_t* id, int32_t n,
+                      int16_t threshold);
+}
+
+#endif
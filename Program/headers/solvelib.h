@@ -10,9 +10,109 @@
 
 #include "errlib.h"
 #include "instrumentslib.h"
+#include "dlxlib.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
 
 namespace pcs
 {
+    // Движки решения : случайное блуждание, систематический перебор,
+    // точное покрытие каталогом путей и отжиг
+    enum Engine {RANDOM_WALK, BACKTRACK, EXACT_COVER, ANNEALING};
+    
+    // Итог решения : решено, решения нет, исчерпан лимит (шагов или времени)
+    enum SolveStatus {SOLVED, UNSOLVABLE, TIMEOUT};
+    
+    // Политики перезапуска (допустимое кол-во проходов без улучшения) :
+    // постоянная, геометрическая, последовательность Луби
+    enum RestartPolicy {RESTART_FIXED, RESTART_GEOMETRIC, RESTART_LUBY};
+    
+    // Действие при перезапуске : новый порядок обхода или очистка поля
+    enum RestartAction {RESHUFFLE, RESET};
+    
+    // Порядок обхода нетривиальных клеток : случайный или "самые
+    // стесненные - первыми" (со случайным разбиением равенств)
+    enum OrderPolicy {ORDER_RANDOM, ORDER_CONSTRAINED};
+    
+    ////////// struct SolveResult ////////////////////////////////////////////
+    // Итог вызова "Solver::solve" со сроком : статус, затраченное время,   //
+    // кол-во итераций (проходов и узлов перебора) и кол-во непостроенных   //
+    // путей лучшего найденного состояния (0, если поле решено).            //
+    //////////////////////////////////////////////////////////////////////////
+    
+    struct SolveResult
+    {
+        public :
+            
+            SolveStatus status;       // Итог решения
+            float       time;         // Затраченное время (сек)
+            int64_t     nIterations;  // Кол-во проходов и узлов перебора
+            int32_t     nMisPaths;    // Непостроенные пути лучшего состояния
+            
+        public :
+            
+            // (1) Конструктор (обнуляет поля)
+            SolveResult();
+            
+            // (2) Конструктор копирования
+            SolveResult(const SolveResult& result) = default;
+            
+            // (3) Перегрузка оператора присваивания
+            SolveResult& operator=(const SolveResult& result) = default;
+            
+            // (4) Деструктор
+            ~SolveResult() = default;
+    };
+    
+    ////////// struct SolverStats ////////////////////////////////////////////
+    // Статистика решения (с последнего "Solver::setField" или "prepare") : //
+    // счетчики работы движков, кол-ва построенных и удаленных путей по     //
+    // значению клетки и время этапов. Счетчики ведутся, только если сбор   //
+    // включен ("Solver::setStats"). Статистики нескольких решателей        //
+    // складываются ("add"), время при этом тоже суммируется.               //
+    //////////////////////////////////////////////////////////////////////////
+    
+    struct SolverStats
+    {
+        public :
+            
+            int64_t nSweeps;        // Проходы блуждания и шаги отжига
+            int64_t nPathCalls;     // Вызовы "createPath"
+            int64_t nWalkSteps;     // Шаги блуждания ("createAreaPath")
+            int64_t nCycleCaps;     // Блуждания до PATH_CYCLES_NUMBER шагов
+            int64_t nBacktracks;    // Откаты перебора (освобождения клеток)
+            int64_t nRipUps;        // Удаления мешающих путей
+            int64_t nRestarts;      // Перезапуски блуждания
+            std::vector<int64_t> nBuilt;   // Построено путей (по значению)
+            std::vector<int64_t> nDeleted; // Удалено путей (по значению)
+            float   prepareTime;    // Время "prepare" (сек)
+            float   solveTime;      // Время "solve" (сек)
+            float   directionTime;  // Время "setDirections" (сек)
+            
+        public :
+            
+            // (1) Конструктор (обнуляет поля)
+            SolverStats();
+            
+            // (2) Конструктор копирования
+            SolverStats(const SolverStats& stats) = default;
+            
+            // (3) Перегрузка оператора присваивания
+            SolverStats& operator=(const SolverStats& stats) = default;
+            
+            // (4) Прибавляет статистику "stats"
+            void add(const SolverStats& stats);
+            
+            // (5) Обнуляет статистику
+            void clear();
+            
+            // (6) Деструктор
+            ~SolverStats() = default;
+    };
+    
     ////////// class Solver //////////////////////////////////////////////////
     // Класс, который содержит в себе все необходимые методы для решения    //
     // филлипинского кроссворда.                                            //
@@ -27,29 +127,186 @@ namespace pcs
     // 3) prepare() :                                                       //
     //    Готовит поле к обработке (обнуляет лишнее, заполняет клетки с 1   //
     //    и 2, выделяет нужный объем памяти для вспомогательных нужд, ищет  //
-    //    все нетривиальные клетки >= 3 и записывает их в отдельный массив) //
+    //    все нетривиальные клетки >= 3 и записывает их в отдельный массив, //
+    //    один раз строит для каждой такой клетки список ее возможных пар   //
+    //    с рабочими областями - в виде массива смещений и массива пар).    //
     // 4) solve(...) :                                                      //
-    //    Разводит случайным образом пути (из нетривиальных клеток) по полю //
-    //    кроссворда.                                                       //
+    //    Разводит пути (из нетривиальных клеток) по полю кроссворда        //
+    //    выбранным движком: RANDOM_WALK - случайным блужданием с           //
+    //    ограниченным числом шагов. Блуждание от клетки к паре ведет карта //
+    //    расстояний до парной клетки по свободным клеткам рабочей области  //
+    //    (обход в ширину). Карта строится при первом обращении и           //
+    //    пересчитывается лениво - только если с момента расчета менялась   //
+    //    хотя бы одна плитка 8x8 поля, задевающая рабочую область. Если    //
+    //    путь не строится, мешающий путь удаляется : мешающие пути         //
+    //    получают затухающие штрафы (путь и клетка, где он помешал), для   //
+    //    удаления чаще выбираются короткие пути с большим штрафом,         //
+    //    последние удаленные пути на время под запретом.                   //
+    //    BACKTRACK - полным перебором в глубину (сначала клетка с          //
+    //    наименьшим числом достижимых пар, безвыходные ветви отсекаются    //
+    //    сразу), который либо находит решение, либо доказывает, что его    //
+    //    нет, либо упирается в лимит времени.                              //
+    //    Занятость клеток путями хэшируется по Зобристу (ключ клетки,      //
+    //    умноженный на ключ пути, обновляется в "occupy/releaseCell"),     //
+    //    состояния, из которых перебор не нашел решения, запоминаются в    //
+    //    таблице перестановок и при повторной встрече сразу отсекаются.    //
+    //    EXACT_COVER - перечисляет все пути каждой пары в ее рабочей       //
+    //    области и решает задачу точного покрытия (каждая клетка с         //
+    //    числом - ровно один раз, пустая - не более одного); если путей    //
+    //    у какой-то пары слишком много, решает случайным блужданием.       //
+    //    ANNEALING - отжиг : шаг удаляет несколько случайных путей и       //
+    //    достраивает свободные клетки без удаления мешающих путей;         //
+    //    ухудшение (меньше клеток под путями) принимается с вероятностью   //
+    //    exp(delta / T). Стоимость меняется на длину каждого добавленного  //
+    //    или удаленного пути, лучшее состояние восстанавливается откатом   //
+    //    журнала изменений путей (без копий поля).                         //
+    //    Перегрузка "solve(deadline)" прерывает любой движок по сроку      //
+    //    (случайное блуждание - между проходами и внутри блуждания раз в   //
+    //    WALK_CHECK_NUMBER шагов "createAreaPath") и возвращает            //
+    //    "SolveResult". Если поле не решено, на нем остается лучшее        //
+    //    найденное состояние (меньше всего непостроенных путей), его       //
+    //    возвращают "getField" и "setDirections".                          //
     // 5) setDirections() :                                                 //
     //    Устанавливает направления путей в каждой клетке (LEFT, RIGHT,     //
     //    VERTICAL, MIDDLE, NONE).                                          //
     // 6) getField(...) :                                                   //
     //    Копирует игровое поле в аргумент.                                 //
+    // 7) setSeed(...) :                                                    //
+    //    Задает зерно собственного генератора случайных чисел (одинаковое  //
+    //    зерно повторяет ход решения).                                     //
+    // 8) setStopFlag(...) :                                                //
+    //    Задает внешний флаг остановки: "solve" прерывается между          //
+    //    проходами, как только флаг установлен (другим потоком). Внутри    //
+    //    блуждания флаг и срок проверяются раз в WALK_CHECK_NUMBER шагов.  //
+    // 9) setEngine(...), setTimeLimit(...) :                               //
+    //    Выбирают движок решения и лимит времени перебора (мс).            //
+    // 10) getStatus() :                                                    //
+    //    Итог последнего "solve" : SOLVED, UNSOLVABLE, TIMEOUT.            //
+    // 11) setRestart(...) :                                                //
+    //    Задает перезапуски случайного блуждания : если кол-во             //
+    //    непостроенных путей не уменьшается заданное политикой число       //
+    //    проходов, то порядок обхода перемешивается (RESHUFFLE) или поле   //
+    //    очищается до состояния после "prepare" (RESET).                   //
+    // 12) setOrder(...) :                                                  //
+    //    Задает порядок обхода клеток при случайном блуждании. В порядке   //
+    //    ORDER_CONSTRAINED первыми идут клетки с наименьшим числом пар,    //
+    //    наименьшим запасом длины ("index - distance") и большим числом    //
+    //    занятых соседей (стены, пути); веса признаков - ORDER_*.          //
+    // 13) splitField(...) :                                                //
+    //    Разбивает поле на независимые части : пары связаны, если их       //
+    //    рабочие области делят хотя бы одну пустую клетку (или клетку      //
+    //    пары). Часть - копия поля, в которой нетривиальные клетки других  //
+    //    частей заменены на 1, поэтому части решаются отдельно, а их       //
+    //    пути не пересекаются.                                             //
+    // 14) findBlocks(...) :                                                //
+    //    Ищет блоки, которые повторяются на поле (двумерный скользящий     //
+    //    хэш по значениям клеток, совпадения проверяются по клеткам) и     //
+    //    самодостаточны (рабочие области всех пар клеток блока лежат       //
+    //    внутри него, и отдельно блок задан корректно). Пустые клетки      //
+    //    блока, через которые могут пройти пути пар вне его копий,         //
+    //    заменены на 1 : пути блока их не займут, поэтому остаток поля     //
+    //    решается, если решается все поле.                                 //
+    //    Размер блока выбирается по наибольшему выигрышу - кол-ву          //
+    //    нетривиальных клеток в копиях, кроме первой копии каждого блока.  //
+    // 15) setTableMemory(...), getTable*Number() :                         //
+    //    Ограничивают память таблицы перестановок перебора (TABLE_MEMORY   //
+    //    по умолчанию) и возвращают счетчики попаданий и промахов.         //
+    // 16) setProgress(...) :                                               //
+    //    Задает обработчик хода решения : каждые INDICATOR_NUMBER проходов //
+    //    блуждания (шагов отжига) он получает кол-во проходов и            //
+    //    непостроенных путей. Вызывается из потока решателя, сам решатель  //
+    //    ничего не выводит.                                                //
+    // 17) setStats(...), getStats() :                                      //
+    //    Включают сбор статистики "SolverStats" (по умолчанию выключен) и  //
+    //    возвращают ее. Время этапов записывается всегда, а счетчики -     //
+    //    только при включенной статистике (проверка флага на событие).     //
     //////////////////////////////////////////////////////////////////////////
     
     class Solver
     {
         private :
             
-            Field                 map_;     // Рабочее поле кроссворда
-            std::vector<Vector>   path_;    // Хранилище прошлых позиций
-            std::vector<Area>     areas_;   // Рабочие зоны текущей клетки
-            std::vector<TrackSeq> track_;   // Информация о сдвигах
-            std::vector<Vector>   points_;  // Набор нетривиальных клеток
-            std::vector<int16_t>  idArray_; // "id" путей в рабочих областях
-            int16_t nAreas_;                // Кол-во точек - соседей
-            int16_t nId_;                   // Кол-во "id" путей в "idArray_"
+            Field                 map_;        // Рабочее поле кроссворда
+            std::vector<TrackSeq> track_;      // Информация о сдвигах
+            std::vector<Vector>   points_;     // Набор нетривиальных клеток
+            std::vector<int16_t>  order_;      // Порядок обхода "points_"
+            std::vector<int16_t>  slotById_;   // Номер в "points_" по "id"
+            std::vector<int32_t>  partnerStart_; // Начало списка пар (CSR)
+            std::vector<Vector>   partners_;   // Пары клеток (по спискам)
+            std::vector<Region>   partnerRegions_; // Рабочие области пар
+            std::vector<int32_t>  candidates_; // Пары текущей клетки
+            std::vector<Vector>   pathCells_;  // Клетки путей по порядку
+            std::vector<int32_t>  pathStart_;  // Начало блока пути (по номеру)
+            std::vector<int16_t>  pathLength_; // Длина пути (по номеру)
+            std::vector<int16_t>  idArray_;    // "id" путей в рабочих областях
+            std::vector<int32_t>  stamp_;      // Метки обхода в ширину
+            std::vector<int16_t>  depth_;      // Глубина обхода (по клетке)
+            std::vector<int32_t>  queue_;      // Очередь обхода в ширину
+            std::vector<Vector>   rowCells_;   // Клетки путей каталога
+            std::vector<int32_t>  rowStart_;   // Начало пути каталога
+            std::vector<int16_t>  rowSlot_;    // Номер начальной клетки пути
+            std::vector<int32_t>  rowColumns_; // Столбцы текущего пути
+            std::vector<int32_t>  columnByPos_; // Столбец пустой клетки
+            ExactCover            cover_;      // Задача точного покрытия
+            std::vector<uint8_t>  distCells_;  // Карты расстояний пар
+            std::vector<int32_t>  distStart_;  // Начало карты пары
+            std::vector<int64_t>  distVersion_; // Версия карты (-1 - нет)
+            std::vector<int32_t>  tileByPos_;  // Плитка клетки (по смещению)
+            std::vector<int64_t>  tileStamp_;  // Версия последнего изменения
+            std::vector<double>   idConflict_; // Штраф пути (по номеру)
+            std::vector<double>   cellConflict_; // Штраф клетки (по смещению)
+            std::vector<double>   ripWeights_; // Веса мешающих путей
+            std::vector<int16_t>  tabu_;       // Недавно удаленные пути
+            std::vector<double>   orderKey_;   // Стесненность клетки (номер)
+            std::vector<double>   orderScore_; // Ключи сортировки обхода
+            std::vector<int16_t>  logSlot_;    // Журнал отжига : +-(номер+1)
+            std::vector<int32_t>  logStart_;   // Начало клеток записи журнала
+            std::vector<Vector>   logCells_;   // Клетки удаленных путей
+            std::vector<uint64_t> zobristCell_; // Ключи Зобриста клеток
+            std::vector<uint64_t> zobristId_;  // Ключи Зобриста путей ("id")
+            TranspositionTable    table_;      // Тупиковые состояния перебора
+            std::vector<uint64_t> blockHash_;  // Префиксные хэши значений
+            std::vector<uint64_t> blockScale_; // Сдвиг хэша в начало блока
+            std::vector<int32_t>  blockCount_; // Префиксные кол-ва нетрив.
+            Field                 bestMap_;    // Лучшее состояние : поле,
+            std::vector<Vector>   bestCells_;  // клетки путей
+            std::vector<int16_t>  bestLength_; // и их длины
+            Random                random_;     // Генератор случайных чисел
+            const std::atomic<bool>* stop_;    // Внешний флаг остановки
+            std::function<void(int32_t, int16_t)> progress_; // Ход решения
+            SolverStats           stats_;      // Статистика решения
+            std::chrono::steady_clock::time_point deadline_; // Конец перебора
+            std::chrono::steady_clock::time_point finish_;   // Срок "solve"
+            Engine      engine_;               // Движок решения
+            SolveStatus status_;               // Итог последнего "solve"
+            int32_t     timeLimit_;            // Лимит времени перебора (мс)
+            int32_t     nStamp_;               // Текущая метка обхода
+            int64_t     nNodes_;               // Кол-во узлов перебора
+            int32_t     nPairPaths_;           // Путей текущей пары
+            int64_t     nChanges_;             // Счетчик изменений плиток
+            double      conflictInc_;          // Текущее приращение штрафа
+            int16_t     nTabu_;                // Место записи в "tabu_"
+            RestartPolicy restartPolicy_;      // Политика перезапусков
+            RestartAction restartAction_;      // Действие при перезапуске
+            int32_t     restartBase_;          // Базовый интервал (проходы)
+            int32_t     nRestarts_;            // Кол-во перезапусков
+            OrderPolicy orderPolicy_;          // Порядок обхода клеток
+            int16_t     nTilesX_;              // Кол-во плиток по "X"
+            bool        isWalking_;            // Идет случайное блуждание
+            bool        isOverflow_;           // Каталог путей переполнен
+            bool        isInterrupted_;        // Перебор прерван
+            int16_t nAreas_;                   // Кол-во точек - соседей
+            int16_t nId_;                      // Кол-во "id" путей в "idArray_"
+            int32_t nSweeps_;                  // Кол-во проходов в "solve"
+            int32_t nMisPoints_;               // Свободные нетрив. клетки
+            int32_t nCovered_;                 // Клетки под путями (нетрив.)
+            uint64_t hash_;                    // Хэш Зобриста занятости клеток
+            int32_t bestMisPoints_;            // Свободные нетрив. (лучшее)
+            int32_t bestCovered_;              // Клетки под путями (лучшее)
+            uint64_t bestHash_;                // Хэш лучшего состояния
+            size_t  tableMemory_;              // Память таблицы перестановок
+            bool    isStatsOn_;                // Статистика включена
+            bool    havePartners_;             // Списки пар построены
             
         public :
             
@@ -81,13 +338,70 @@ namespace pcs
             // (8) Разводит пути на поле (если это удается)
             void solve(bool& wasSolved);
             
-            // (9) Задает направления обхода путей (для вывода на экран)
+            // (9) Разводит пути до срока "deadline" (по возможности)
+            SolveResult solve(std::chrono::steady_clock::time_point deadline);
+            
+            // (10) Разбивает поле на независимые части
+            void splitField(std::vector<Field>& parts);
+            
+            // (11) Находит повторяющиеся самодостаточные блоки поля
+            void findBlocks(std::vector<Field>& blocks,
+                            std::vector<std::vector<Vector>>& copies);
+            
+            // (12) Задает направления обхода путей (для вывода на экран)
             void setDirections();
             
-            // (10) Освобождает выделенную память
+            // (13) Освобождает выделенную память
             void clear();
             
-            // (11) Деструктор
+            // (14) Задает зерно генератора случайных чисел
+            void setSeed(uint64_t seed);
+            
+            // (15) Задает внешний флаг остановки (nullptr - нет флага)
+            void setStopFlag(const std::atomic<bool>* stop);
+            
+            // (16) Задает обработчик хода решения (пустой - без индикации)
+            void setProgress(const std::function<void(int32_t, int16_t)>&
+                             progress);
+            
+            // (17) Выбирает движок решения
+            void setEngine(Engine engine);
+            
+            // (18) Задает лимит времени перебора (мс)
+            void setTimeLimit(int32_t timeLimit);
+            
+            // (19) Возвращает итог последнего "solve"
+            SolveStatus getStatus() const;
+            
+            // (20) Задает политику перезапусков
+            void setRestart(RestartPolicy policy, RestartAction action,
+                            int32_t base);
+            
+            // (21) Задает порядок обхода нетривиальных клеток
+            void setOrder(OrderPolicy policy);
+            
+            // (22) Возвращает кол-во проходов последнего "solve"
+            int32_t getSweepNumber() const;
+            
+            // (23) Возвращает кол-во перезапусков последнего "solve"
+            int32_t getRestartNumber() const;
+            
+            // (24) Задает память таблицы перестановок (0 - без таблицы)
+            void setTableMemory(size_t memory);
+            
+            // (25) Возвращает кол-во попаданий в таблицу перестановок
+            int64_t getTableHitNumber() const;
+            
+            // (26) Возвращает кол-во промахов таблицы перестановок
+            int64_t getTableMissNumber() const;
+            
+            // (27) Включает или выключает сбор статистики
+            void setStats(bool isEnabled);
+            
+            // (28) Возвращает статистику решения
+            const SolverStats& getStats() const;
+            
+            // (29) Деструктор
             ~Solver() = default;
             
         private :
@@ -95,72 +409,199 @@ namespace pcs
             ////////// Создание рабочих и поисковых областей /////////////////
             
             // (1) Составляет область поиска соседей
-            void createCheckingArea(Vector point, Area& curArea);
+            void createCheckingArea(Vector point, Region& region);
             
             // (2) Составляет рабочую область для двух точек
-            void createWorkingArea(Vector p1, Vector p2, Area& curArea);
+            void createWorkingArea(Vector p1, Vector p2, Region& region);
             
-            // (3) Точки являются соседями?
+            // (3) Составляет область клеток "c" : |p1 - c| + |c - p2| <= budget
+            void createRegion(Vector p1, Vector p2, int16_t budget,
+                              Region& region);
+            
+            // (4) Точки являются соседями?
             bool areRelatedPoints(Vector p1, Vector p2);
             
-            // (4) Создает рабочие области для "point"
-            void createWorkingAreas(Vector point);
+            // (5) Находит нетривиальные клетки и списки их пар
+            void createPartners();
+            
+            // (6) Корень множества клетки номер "slot" (со сжатием путей)
+            int16_t findRoot(std::vector<int16_t>& parent, int16_t slot);
+            
+            // (7) Расстояния от клетки "from" по свободным пустым клеткам
+            void spreadDistances(Vector from, int16_t limit,
+                                 const Region& region,
+                                 std::vector<int16_t>& dist,
+                                 std::vector<int32_t>& cells);
+            
+            ////////// Повторяющиеся блоки ///////////////////////////////////
+            
+            // (8) Выбирает блоки "sizeX x sizeY" (возвращает выигрыш)
+            int32_t chooseBlocks(int16_t sizeX, int16_t sizeY, bool isChecked,
+                                 std::vector<Field>& blocks,
+                                 std::vector<std::vector<Vector>>& copies);
+            
+            // (9) Рабочие области пар клеток блока лежат внутри него?
+            bool isInsideBlock(int16_t x, int16_t y, int16_t sizeX,
+                               int16_t sizeY);
+            
+            // (10) Закрывает клетки блоков, нужные парам вне копий (выигрыш)
+            int32_t lockBlocks(std::vector<Field>& blocks,
+                               std::vector<std::vector<Vector>>& copies);
             
             ////////// Построение и удаление путей ///////////////////////////
             
-            // (5) Строит (по возможности) все пути
+            // (11) Разводит пути случайным блужданием
+            void solveRandom();
+            
+            // (12) Допустимое кол-во проходов без улучшения до перезапуска
+            int32_t getRestartLimit() const;
+            
+            // (13) Перезапускает блуждание
+            void restart();
+            
+            // (14) Составляет порядок обхода нетривиальных клеток
+            void createOrder();
+            
+            // (15) Вычисляет постоянную часть стесненности клеток
+            void createOrderKeys();
+            
+            // (16) Строит (по возможности) все пути
             void createAllPaths();
             
-            // (6) Строит путь из точки "point"
-            void createPath(Vector point);
+            // (17) Строит путь из точки "point" (canRip - удалять помехи)
+            void createPath(Vector point, bool canRip);
             
-            // (7) Создает новый путь из точки "point" в родственную точку
-            void createAreaPath(Vector point, Area curArea, bool& wasCreated);
+            // (18) Создает новый путь из точки "point" в ее пару номер "pair"
+            void createAreaPath(Vector point, int32_t pair, bool& wasCreated);
             
-            // (8) Удаляет путь с началом в точке "point"
-            void deletePath(Vector point);
+            // (19) Удаляет путь из точки "point" (isUndo - откат журнала)
+            void deletePath(Vector point, bool isUndo = false);
             
-            // (9) Удаляет путь с номером "id"
+            // (20) Удаляет путь с номером "id"
             void deletePath(int16_t id);
             
-            // (10) Удаляет мешающий путь и добавляет его начало в стек 
+            // (21) Удаляет мешающий путь (с учетом штрафов конфликтов)
             void deleteRandomPath(bool& wasDeleted);
             
+            // (22) Вес удаления пути "id" (частые помехи, короткий путь)
+            double getRipWeight(int16_t id);
+            
+            // (23) Путь "id" удален недавно?
+            bool isTabu(int16_t id);
+            
+            // (24) Начисляет штраф пути "id", помешавшему в клетке "pos"
+            void addConflict(int16_t id, int32_t pos);
+            
+            ////////// Систематический перебор (BACKTRACK) ///////////////////
+            
+            // (25) Перебирает пары и пути в глубину
+            void solveBacktrack();
+            
+            // (26) Строит пути из оставшихся клеток (true - решено)
+            bool searchPoints();
+            
+            // (27) Продолжает путь номер "slot" из клетки "pos" к "target"
+            bool searchPath(int16_t slot, int32_t pos, Vector cur,
+                            int16_t step, Vector target);
+            
+            // (28) Считает пары клетки номер "slot", достижимые по свободным
+            int16_t countLivePartners(int16_t slot);
+            
+            // (29) Проверяет лимит времени и флаг остановки
+            bool isTimeUp();
+            
+            // (30) Установлен флаг остановки или истек срок "solve"?
+            bool isCancelled() const;
+            
+            ////////// Точное покрытие (EXACT_COVER) /////////////////////////
+            
+            // (31) Решает поле как задачу точного покрытия
+            void solveExactCover();
+            
+            // (32) Составляет каталог путей всех пар (false - переполнен)
+            bool createCatalogue();
+            
+            // (33) Перечисляет пути номер "slot" из клетки "pos" к "target"
+            void enumeratePaths(int16_t slot, int32_t pos, Vector cur,
+                                int16_t step, Vector target,
+                                const Region& region);
+            
+            ////////// Отжиг (ANNEALING) /////////////////////////////////////
+            
+            // (34) Разводит пути отжигом
+            void solveAnneal();
+            
+            // (35) Удаляет несколько случайных путей и достраивает поле
+            void changeMap();
+            
+            // (36) Записывает в журнал добавление или удаление пути "slot"
+            void recordPath(int16_t slot, bool wasAdded);
+            
+            // (37) Откатывает журнал до длины "mark"
+            void undoLog(int32_t mark);
+            
+            // (38) Снова прокладывает путь номер "slot" по клеткам "cells"
+            void restorePath(int16_t slot, const Vector* cells,
+                             int16_t length);
+            
+            ////////// Карты расстояний пар //////////////////////////////////
+            
+            // (39) Возвращает актуальную карту расстояний пары "pair"
+            const uint8_t* getDistances(int32_t pair);
+            
+            // (40) Строит карту расстояний пары "pair" обходом в ширину
+            void createDistances(int32_t pair);
+            
+            // (41) Отмечает изменение плитки клетки "pos"
+            void touchTile(int32_t pos);
+            
+            // (42) Добавляет "id" путей, мешающих паре "pair" точки "point"
+            void collectBlockers(Vector point, int32_t pair);
+            
             ////////// Анализ ситуации на поле ///////////////////////////////
             
-            // (11) Возвращает количество непостроенных путей
+            // (43) Возвращает количество непостроенных путей (за O(1))
             int16_t getMisPathNumber();
             
+            // (44) Запоминает состояние, если свободных клеток меньше
+            void saveBest(bool isForced);
+            
+            // (45) Возвращает лучшее запомненное состояние
+            void restoreBest();
+            
             ////////// Проверка корректности поля ////////////////////////////
             
-            // (12) Проверяет наличие соседей точки "point"
+            // (46) Проверяет наличие соседей точки "point"
             bool haveFriends(Vector point);
             
-            // (13) Проверяет наличие соседей во всех клетках > 1
+            // (47) Проверяет наличие соседей во всех клетках > 1
             bool isCorrectRelations();
             
-            // (14) Проверить, что непустые клетки (>= 2) образуют пары
+            // (48) Проверить, что непустые клетки (>= 2) образуют пары
             bool isCorrectNumber();
             
             ////////// Вспомогательные методы ////////////////////////////////
             
-            // (15) Устанавливает направление обхода в точке "point"
-            void setDirection(Vector point);
+            // (49) Устанавливает направление обхода в клетке пути "dot"
+            void setDirection(Vector prev, Vector dot, Vector next);
             
-            // (16) Находит предыдущую и следующую точки пути
-            void findNear(Vector dot, bool& hL, bool& hR, bool& hU, bool& hD);
-            
-            // (17) Возвращает направление пути в точке по ее соседям
+            // (50) Возвращает направление пути в точке по ее соседям
             Direction getDirection(bool hL, bool hR, bool hU, bool hD);
             
-            // (18) Добавляет новый "id" в массив всех "id" области
+            // (51) Добавляет новый "id" в массив всех "id" области
             void addId(int16_t id);
             
-            // (19) Добавляет "id" точки "curPoint" в список всех "id"
-            void checkAddId(Vector point, Vector curPoint);
+            // (52) Добавляет "id" клетки "pos" в список всех "id"
+            void checkAddId(int16_t index, int16_t protoId, int32_t pos);
             
-            // (20) Возвращает координаты точки с таким "protoId"
+            // (53) Возвращает координаты точки с таким "protoId"
             Vector getPosition(int16_t id);
+            
+            // (54) Занимает клетку "pos" путем "id" (номер в пути - "num")
+            void occupyCell(int32_t pos, int16_t id, int16_t num);
+            
+            // (55) Освобождает клетку "pos"
+            void releaseCell(int32_t pos);
     };
 }
 
@@ -0,0 +1,248 @@
+////////// dlxlib ////////////////////////////////////////////////////////////
+// Автор    : Баталов Семен                                                 //
+// Дата     : 08.11.2020                                                    //
+// Описание : Здесь представлен решатель задачи точного покрытия            //
+//            (алгоритм X Кнута на "танцующих ссылках").                    //
+//////////////////////////////////////////////////////////////////////////////
+
+#include "dlxlib.h"
+
+using namespace pcs;
+
+////////// class ExactCover //////////////////////////////////////////////////
+// Описание : dlxlib.h                                                      //
+//////////////////////////////////////////////////////////////////////////////
+
+////////// public ////////////////////////////////////////////////////////////
+
+// (1) Конструктор
+ExactCover::ExactCover()
+{
+    nColumns_      = 0;
+    nRows_         = 0;
+    nNodes_        = 0;
+    isInterrupted_ = false;
+}
+
+// (4) Задает столбцы (сначала основные, затем дополнительные)
+void ExactCover::setColumns(int32_t nPrimary, int32_t nSecondary)
+{
+    clear();
+    nColumns_ = nPrimary + nSecondary;
+    
+    // Узлы 0..nColumns_ - 1 - заголовки столбцов, nColumns_ - корень
+    left_.resize(nColumns_ + 1);
+    right_.resize(nColumns_ + 1);
+    up_.resize(nColumns_ + 1);
+    down_.resize(nColumns_ + 1);
+    column_.resize(nColumns_ + 1);
+    row_.assign(nColumns_ + 1, -1);
+    size_.assign(nColumns_, 0);
+    
+    for (int32_t col = 0; col <= nColumns_; ++col)
+    {
+        up_[col]     = col;
+        down_[col]   = col;
+        column_[col] = col;
+        left_[col]   = col;
+        right_[col]  = col;
+    }
+    
+    // В список корня входят только основные столбцы
+    for (int32_t col = 0; col < nPrimary; ++col)
+    {
+        left_[col]               = left_[nColumns_];
+        right_[col]              = nColumns_;
+        right_[left_[nColumns_]] = col;
+        left_[nColumns_]         = col;
+    }
+}
+
+// (5) Добавляет строку из столбцов "columns"
+void ExactCover::addRow(const std::vector<int32_t>& columns)
+{
+    int32_t first = left_.size();
+    
+    for (int32_t k = 0; k < columns.size(); ++k)
+    {
+        int32_t col  = columns[k];
+        int32_t node = left_.size();
+        
+        // Вставляем узел в конец столбца
+        up_.push_back(up_[col]);
+        down_.push_back(col);
+        down_[up_[col]] = node;
+        up_[col]        = node;
+        ++size_[col];
+        
+        // И в конец (кольцевой) строки
+        left_.push_back(k == 0 ? node : node - 1);
+        right_.push_back(first);
+        if (k > 0)
+        {
+            right_[node - 1] = node;
+            left_[first]     = node;
+        }
+        column_.push_back(col);
+        row_.push_back(nRows_);
+    }
+    ++nRows_;
+}
+
+// (6) Ищет покрытие (номера строк - в "rows")
+bool ExactCover::solve(std::vector<int32_t>& rows,
+                       const std::function<bool()>& isTimeUp)
+{
+    nNodes_        = 0;
+    isInterrupted_ = false;
+    solution_.clear();
+    answer_.clear();
+    
+    // Перебор возвращает матрицу в исходное состояние
+    bool found = search(isTimeUp);
+    
+    rows = answer_;
+    return found;
+}
+
+// (7) Перебор был прерван?
+bool ExactCover::wasInterrupted() const
+{
+    return isInterrupted_;
+}
+
+// (8) Возвращает кол-во узлов последнего перебора
+int64_t ExactCover::getNodeNumber() const
+{
+    return nNodes_;
+}
+
+// (9) Возвращает кол-во узлов матрицы (память)
+int32_t ExactCover::getCellNumber() const
+{
+    return left_.size();
+}
+
+// (10) Освобождает выделенную память
+void ExactCover::clear()
+{
+    left_.clear();
+    right_.clear();
+    up_.clear();
+    down_.clear();
+    column_.clear();
+    row_.clear();
+    size_.clear();
+    solution_.clear();
+    answer_.clear();
+    nColumns_      = 0;
+    nRows_         = 0;
+    nNodes_        = 0;
+    isInterrupted_ = false;
+}
+
+////////// private ///////////////////////////////////////////////////////////
+
+// (1) Убирает столбец "col" и все пересекающие его строки
+void ExactCover::cover(int32_t col)
+{
+    right_[left_[col]] = right_[col];
+    left_[right_[col]] = left_[col];
+    
+    for (int32_t i = down_[col]; i != col; i = down_[i])
+    {
+        for (int32_t j = right_[i]; j != i; j = right_[j])
+        {
+            down_[up_[j]] = down_[j];
+            up_[down_[j]] = up_[j];
+            --size_[column_[j]];
+        }
+    }
+}
+
+// (2) Возвращает столбец "col" (обратно к "cover")
+void ExactCover::uncover(int32_t col)
+{
+    for (int32_t i = up_[col]; i != col; i = up_[i])
+    {
+        for (int32_t j = left_[i]; j != i; j = left_[j])
+        {
+            ++size_[column_[j]];
+            down_[up_[j]] = j;
+            up_[down_[j]] = j;
+        }
+    }
+    
+    right_[left_[col]] = col;
+    left_[right_[col]] = col;
+}
+
+// (3) Выбирает основной столбец с наименьшим числом строк
+int32_t ExactCover::chooseColumn() const
+{
+    int32_t best = right_[nColumns_];
+    
+    for (int32_t col = best; col != nColumns_ && size_[best] > 1;
+         col = right_[col])
+    {
+        if (size_[col] < size_[best])
+        {
+            best = col;
+        }
+    }
+    return best;
+}
+
+// (4) Рекурсивный перебор (true - покрытие найдено)
+bool ExactCover::search(const std::function<bool()>& isTimeUp)
+{
+    bool found = false;
+    
+    // Все основные столбцы покрыты
+    if (right_[nColumns_] == nColumns_)
+    {
+        answer_.clear();
+        for (int32_t k = 0; k < solution_.size(); ++k)
+        {
+            answer_.push_back(row_[solution_[k]]);
+        }
+        return true;
+    }
+    
+    ++nNodes_;
+    if (isTimeUp())
+    {
+        isInterrupted_ = true;
+        return false;
+    }
+    
+    // Столбец без строк - тупик
+    int32_t col = chooseColumn();
+    if (size_[col] == 0)
+    {
+        return false;
+    }
+    
+    // Пробуем по очереди все строки, покрывающие столбец
+    cover(col);
+    for (int32_t r = down_[col]; r != col && !found && !isInterrupted_;
+         r = down_[r])
+    {
+        solution_.push_back(r);
+        for (int32_t j = right_[r]; j != r; j = right_[j])
+        {
+            cover(column_[j]);
+        }
+        
+        found = search(isTimeUp);
+        
+        for (int32_t j = left_[r]; j != r; j = left_[j])
+        {
+            uncover(column_[j]);
+        }
+        solution_.pop_back();
+    }
+    uncover(col);
+    
+    return found;
+}
\ No newline at end of file
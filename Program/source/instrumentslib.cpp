@@ -101,6 +101,189 @@ int16_t pcs::min(int16_t var1, int16_t var2)
     }
 }
 
+////////// temperature ///////////////////////////////////////////////////////
+// Описание : instrumentslib.h                                              //
+//////////////////////////////////////////////////////////////////////////////
+
+double pcs::temperature(int32_t step)
+{
+    if (step >= 0)
+    {
+        return ANNEAL_MAX_T * exp(-ANNEAL_ALPHA * step);
+    }
+    return 0.0;
+}
+
+////////// class Random //////////////////////////////////////////////////////
+// Описание : instrumentslib.h                                              //
+//////////////////////////////////////////////////////////////////////////////
+
+// Зерно генератора по умолчанию
+static const uint64_t DEFAULT_SEED = 0x5DEECE66DULL;
+
+// Циклический сдвиг влево
+static uint64_t rotl(uint64_t value, int shift)
+{
+    return (value << shift) | (value >> (64 - shift));
+}
+
+// (1) Конструктор (зерно по умолчанию)
+Random::Random()
+{
+    setSeed(DEFAULT_SEED);
+}
+
+// (2) Конструктор от зерна
+Random::Random(uint64_t seed)
+{
+    setSeed(seed);
+}
+
+// (5) Задает зерно генератора
+void Random::setSeed(uint64_t seed)
+{
+    // Заполняем состояние последовательностью splitmix64
+    for (int i = 0; i < 4; ++i)
+    {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+        
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        state_[i] = z ^ (z >> 31);
+    }
+}
+
+// (6) Возвращает очередное 64-битное число
+uint64_t Random::next()
+{
+    uint64_t result = rotl(state_[1] * 5, 7) * 9;
+    uint64_t temp   = state_[1] << 17;
+    
+    state_[2] ^= state_[0];
+    state_[3] ^= state_[1];
+    state_[1] ^= state_[2];
+    state_[0] ^= state_[3];
+    state_[2] ^= temp;
+    state_[3]  = rotl(state_[3], 45);
+    
+    return result;
+}
+
+// (7) Возвращает случайное число из [0, range) (range > 0)
+uint32_t Random::uniform(uint32_t range)
+{
+    // Умножение вместо деления (старшие 32 бита произведения)
+    return static_cast<uint32_t> (((next() >> 32) * range) >> 32);
+}
+
+// (8) Возвращает случайное число из [0, 1)
+double Random::uniformReal()
+{
+    // Старшие 53 бита - мантисса числа двойной точности
+    return (next() >> 11) * 0x1.0p-53;
+}
+
+////////// class TranspositionTable //////////////////////////////////////////
+// Описание : instrumentslib.h                                              //
+//////////////////////////////////////////////////////////////////////////////
+
+// (1) Конструктор (пустая таблица)
+TranspositionTable::TranspositionTable()
+{
+    mask_    = 0;
+    nHits_   = 0;
+    nMisses_ = 0;
+}
+
+// (4) Выделяет не более "memory" байт и очищает таблицу
+void TranspositionTable::setMemory(size_t memory)
+{
+    size_t nBuckets = 1;
+    
+    // Кол-во корзин - наибольшая степень двойки, умещающаяся в "memory"
+    // (если не умещается и одна корзина - таблица отключена)
+    while (nBuckets * 2 * TABLE_BUCKET_SIZE * sizeof(uint64_t) <= memory)
+    {
+        nBuckets *= 2;
+    }
+    if (memory >= TABLE_BUCKET_SIZE * sizeof(uint64_t))
+    {
+        keys_.assign(nBuckets * TABLE_BUCKET_SIZE, 0);
+    }
+    else
+    {
+        std::vector<uint64_t>().swap(keys_);
+    }
+    mask_    = nBuckets - 1;
+    nHits_   = 0;
+    nMisses_ = 0;
+}
+
+// (5) Ключ есть в таблице? (считает попадания и промахи)
+bool TranspositionTable::find(uint64_t key)
+{
+    // Таблица без памяти отключена (счетчики не меняются)
+    if (keys_.empty())
+    {
+        return false;
+    }
+    key = (key == 0) ? 1 : key;
+    
+    const uint64_t* bucket = &keys_[(key & mask_) * TABLE_BUCKET_SIZE];
+    
+    for (int16_t i = 0; i < TABLE_BUCKET_SIZE; ++i)
+    {
+        if (bucket[i] == key)
+        {
+            ++nHits_;
+            return true;
+        }
+    }
+    ++nMisses_;
+    return false;
+}
+
+// (6) Добавляет ключ
+void TranspositionTable::insert(uint64_t key)
+{
+    if (!keys_.empty())
+    {
+        key = (key == 0) ? 1 : key;
+        
+        uint64_t* bucket = &keys_[(key & mask_) * TABLE_BUCKET_SIZE];
+        
+        // Свободная запись корзины, иначе - вытесняем одну из записей
+        for (int16_t i = 0; i < TABLE_BUCKET_SIZE; ++i)
+        {
+            if (bucket[i] == 0 || bucket[i] == key)
+            {
+                bucket[i] = key;
+                return;
+            }
+        }
+        bucket[(key >> 62) % TABLE_BUCKET_SIZE] = key;
+    }
+}
+
+// (7) Возвращает кол-во попаданий
+int64_t TranspositionTable::getHitNumber() const
+{
+    return nHits_;
+}
+
+// (8) Возвращает кол-во промахов
+int64_t TranspositionTable::getMissNumber() const
+{
+    return nMisses_;
+}
+
+// (9) Освобождает выделенную память
+void TranspositionTable::clear()
+{
+    std::vector<uint64_t>().swap(keys_);
+    mask_ = 0;
+}
+
 ////////// struct Cell ///////////////////////////////////////////////////////
 // Описание : instrumentslib.h                                              //
 //////////////////////////////////////////////////////////////////////////////
@@ -121,20 +304,109 @@ void Cell::clear()
     way     = NONE;
 }
 
+////////// class WayRef //////////////////////////////////////////////////////
+// Описание : instrumentslib.h                                              //
+//////////////////////////////////////////////////////////////////////////////
+
+// (1) Конструктор (от элемента плоскости)
+WayRef::WayRef(int8_t& way) : way_(way)
+{
+}
+
+// (3) Перегрузка оператора присваивания (значения)
+WayRef& WayRef::operator=(const WayRef& wayRef)
+{
+    way_ = wayRef.way_;
+    return *this;
+}
+
+// (4) Перегрузка оператора присваивания (направления)
+WayRef& WayRef::operator=(Direction way)
+{
+    way_ = static_cast<int8_t> (way);
+    return *this;
+}
+
+// (5) Приведение к направлению
+WayRef::operator Direction() const
+{
+    return static_cast<Direction> (way_);
+}
+
+////////// struct CellRef ////////////////////////////////////////////////////
+// Описание : instrumentslib.h                                              //
+//////////////////////////////////////////////////////////////////////////////
+
+// (1) Конструктор (от элементов плоскостей)
+CellRef::CellRef(int16_t& newIndex, int16_t& newId, int16_t& newNum,
+                 int16_t newProtoId, int8_t& newWay) :
+    index(newIndex), id(newId), num(newNum), protoId(newProtoId), way(newWay)
+{
+}
+
+// (3) Перегрузка оператора присваивания (значений клетки)
+CellRef& CellRef::operator=(const CellRef& cell)
+{
+    index = cell.index;
+    id    = cell.id;
+    num   = cell.num;
+    way   = cell.way;
+    return *this;
+}
+
+// (4) Перегрузка оператора присваивания (от "Cell")
+CellRef& CellRef::operator=(const Cell& cell)
+{
+    index = cell.index;
+    id    = cell.id;
+    num   = cell.num;
+    way   = cell.way;
+    return *this;
+}
+
+// (5) Приведение к "Cell" (копия значений)
+CellRef::operator Cell() const
+{
+    Cell cell;
+    
+    cell.index   = index;
+    cell.id      = id;
+    cell.num     = num;
+    cell.protoId = protoId;
+    cell.way     = way;
+    return cell;
+}
+
 ////////// class Field ///////////////////////////////////////////////////////
 // Описание : instrumentslib.h                                              //
 //////////////////////////////////////////////////////////////////////////////
 
+// Размер буфера (в байтах) для плоскостей длины "length"
+static size_t planesBytes(int32_t length)
+{
+    return (3 * sizeof(int16_t) + sizeof(int8_t)) * length;
+}
+
 // (1) Конструктор (обнуляет поля)
 Field::Field()
 {
-    cells_ = nullptr;
-    sizeX_ = 0;
-    sizeY_ = 0;
+    index_  = nullptr;
+    id_     = nullptr;
+    num_    = nullptr;
+    way_    = nullptr;
+    length_ = 0;
+    stride_ = 0;
+    sizeX_  = 0;
+    sizeY_  = 0;
+    
+    for (int16_t dir = 0; dir < 4; ++dir)
+    {
+        shift_[dir] = 0;
+    }
 }
 
 // (2) Конструктор копирования
-Field::Field(const Field& field)
+Field::Field(const Field& field) : Field()
 {
     *this = field;
 }
@@ -150,12 +422,11 @@ Field& Field::operator=(const Field& field)
             {
                 resize(field.sizeX_, field.sizeY_);
             }
-            for (int i = 0; i < sizeX_; ++i)
+            
+            // Плоскости лежат в одном буфере, копируем его целиком
+            if (index_ != nullptr && field.index_ != nullptr)
             {
-                for (int j = 0; j < sizeY_; ++j)
-                {
-                    cells_[i][j] = field.cells_[i][j];
-                }
+                memcpy(index_, field.index_, planesBytes(length_));
             }
         }
         catch (...)
@@ -166,7 +437,45 @@ Field& Field::operator=(const Field& field)
     return *this;
 }
 
-// (4) Изменяет размер поля, уничтожая имеющуюся информацию
+// (4) Конструктор перемещения
+Field::Field(Field&& field) noexcept : Field()
+{
+    *this = std::move(field);
+}
+
+// (5) Перегрузка оператора перемещающего присваивания
+Field& Field::operator=(Field&& field) noexcept
+{
+    if (this != &field)
+    {
+        clear();
+        index_  = field.index_;
+        id_     = field.id_;
+        num_    = field.num_;
+        way_    = field.way_;
+        length_ = field.length_;
+        stride_ = field.stride_;
+        sizeX_  = field.sizeX_;
+        sizeY_  = field.sizeY_;
+        
+        for (int16_t dir = 0; dir < 4; ++dir)
+        {
+            shift_[dir] = field.shift_[dir];
+        }
+        
+        field.index_  = nullptr;
+        field.id_     = nullptr;
+        field.num_    = nullptr;
+        field.way_    = nullptr;
+        field.length_ = 0;
+        field.stride_ = 0;
+        field.sizeX_  = 0;
+        field.sizeY_  = 0;
+    }
+    return *this;
+}
+
+// (6) Изменяет размер поля, уничтожая имеющуюся информацию
 void Field::resize(int16_t sizeX, int16_t sizeY)
 {
     // Проверка на выход за границы аргументов
@@ -178,24 +487,34 @@ void Field::resize(int16_t sizeX, int16_t sizeY)
         if ((sizeX_ != sizeX || sizeY_ != sizeY) && inRange)
         {
             clear();
-            sizeX_ = sizeX;
-            sizeY_ = sizeY;
             
-            // Выделяем память под двумерный массив
-            cells_ = new Cell*[sizeX_];
-            for (int i = 0; i < sizeX_; ++i)
-            {
-                cells_[i] = new Cell[sizeY_];
-            }
+            // Длина плоскости с рамкой, дополненная до кратной "PLANE_STEP"
+            int32_t length = (sizeX + 2) * (sizeY + 2) + simd::PLANE_STEP - 1;
+            length -= length % simd::PLANE_STEP;
             
-            // Инициализируем все значения "protoId"
-            for (int j = 0; j < sizeY_; ++j)
+            // Выделяем один выровненный буфер под все плоскости
+            void* memory = ::operator new(planesBytes(length),
+                                          std::align_val_t(CELLS_ALIGNMENT));
+            memset(memory, 0, planesBytes(length));
+            
+            index_  = static_cast<int16_t*> (memory);
+            id_     = index_ + length;
+            num_    = id_    + length;
+            way_    = reinterpret_cast<int8_t*> (num_ + length);
+            length_ = length;
+            stride_ = sizeX + 2;
+            sizeX_  = sizeX;
+            sizeY_  = sizeY;
+            
+            // Смещения соседних клеток (в порядке "SHIFT_X", "SHIFT_Y")
+            for (int16_t dir = 0; dir < 4; ++dir)
             {
-                for (int i = 0; i < sizeX_; ++i)
-                {
-                    cells_[i][j].protoId = sizeX_ * j + i + 1;
-                }
+                shift_[dir] = SHIFT_Y[dir] * stride_ + SHIFT_X[dir];
             }
+            
+            // Все клетки пусты, рамка занята "стеной"
+            memset(way_, NONE, length_);
+            buildWalls();
         }
         else
         if (!inRange)
@@ -210,104 +529,93 @@ void Field::resize(int16_t sizeX, int16_t sizeY)
     }
 }
 
-// (5) Перегрузка оператора ()
-Cell& Field::operator()(int16_t x, int16_t y)
+// (7) Перегрузка оператора ()
+CellRef Field::operator()(int16_t x, int16_t y)
 {
     if (!inRange(x, y))
     {
         throw err::PcsException(0);
     }
-    return cells_[x][y];
-}
-
-// (6) Перегрузка оператора ()
-const Cell& Field::operator()(int16_t x, int16_t y) const
-{
-    return this->operator()(x, y);
+    
+    int32_t pos = getPos(x, y);
+    return CellRef(index_[pos], id_[pos], num_[pos], sizeX_ * y + x + 1,
+                   way_[pos]);
 }
 
-// (7) Перегрузка оператора () (через Vector)
-Cell& Field::operator()(Vector point)
+// (8) Перегрузка оператора ()
+Cell Field::operator()(int16_t x, int16_t y) const
 {
-    if (!inRange(point))
+    if (!inRange(x, y))
     {
         throw err::PcsException(0);
     }
-    return cells_[point.x][point.y];
+    
+    int32_t pos = getPos(x, y);
+    Cell    cell;
+    
+    cell.index   = index_[pos];
+    cell.id      = id_[pos];
+    cell.num     = num_[pos];
+    cell.protoId = sizeX_ * y + x + 1;
+    cell.way     = static_cast<Direction> (way_[pos]);
+    return cell;
 }
 
-// (8) Перегрузка оператора () (через Vector)
-const Cell& Field::operator()(Vector point) const
+// (9) Перегрузка оператора () (через Vector)
+CellRef Field::operator()(Vector point)
 {
-    return this->operator()(point);
+    return this->operator()(point.x, point.y);
 }
 
-// (9) Возвращает размер по "X"
+// (10) Перегрузка оператора () (через Vector)
+Cell Field::operator()(Vector point) const
+{
+    return this->operator()(point.x, point.y);
+}
+
+// (11) Возвращает размер по "X"
 int16_t Field::getSizeX() const
 {
     return sizeX_;
 }
 
-// (10) Возвращает размер по "Y"
+// (12) Возвращает размер по "Y"
 int16_t Field::getSizeY() const
 {
     return sizeY_;
 }
 
-// (11) Проверяет поле на отсутствие индексов
+// (13) Проверяет поле на отсутствие индексов
 bool Field::isEmpty() const
 {
-    bool haveIndex = false;
-    
-    // Проходим по полю и проверяем наличие индексов
-    for (int16_t j = 0; j < sizeY_; ++j)
-    {
-        for (int16_t i = 0; i < sizeX_; ++i)
-        {
-            haveIndex = haveIndex || cells_[i][j].index != 0;
-        }
-    }
-    return !haveIndex;
+    return !simd::anyNonZero(index_, length_);
 }
 
-// (12) Проверяет соответствие размеров поля
+// (14) Проверяет соответствие размеров поля
 bool Field::isCorrectSize() const
 {
     return inRangeSizeX(sizeX_) && inRangeSizeY(sizeY_);
 }
 
-// (13) Проверяет корректность задания индексов
+// (15) Проверяет корректность задания индексов
 bool Field::isCorrectIndex() const
 {
-    bool isInRange = true;
-    
-    // Проходим по полю и проверяем корректность индексов
-    for (int16_t j = 0; j < sizeY_; ++j)
-    {
-        for (int16_t i = 0; i < sizeX_; ++i)
-        {
-            isInRange = isInRange && inRangeIndex(cells_[i][j].index);
-        }
-    }
-    return isInRange;
+    return simd::allInRange(index_, length_, MIN_INDEX, MAX_INDEX);
 }
 
-// (14) Оставляет индексы и обнуляет все остальное
+// (16) Оставляет индексы и обнуляет все остальное
 void Field::refresh()
 {
-    // Проходим по полю, оставляя только индексы
-    for (int16_t j = 0; j < sizeY_; ++j)
+    if (index_ != nullptr)
     {
-        for (int16_t i = 0; i < sizeX_; ++i)
-        {
-            cells_[i][j].way = NONE;
-            cells_[i][j].num = 0;
-            cells_[i][j].id  = 0;
-        }
+        memset(id_,  0, sizeof(int16_t) * length_);
+        memset(num_, 0, sizeof(int16_t) * length_);
+        memset(way_, NONE, length_);
+        buildWalls();
     }
 }
 
-// (15) "true" если не выходим за границу
+// (17) "true" если не выходим за границу
 bool Field::inRange(int16_t x, int16_t y) const
 {
     // Находятся ли аргументы в диапазоне
@@ -317,82 +625,87 @@ bool Field::inRange(int16_t x, int16_t y) const
     return isOkX && isOkY;
 }
 
-// (16) "true" если не выходим за границу (через Vector)
+// (18) "true" если не выходим за границу (через Vector)
 bool Field::inRange(Vector point) const
 {
     return inRange(point.x, point.y);
 }
 
-// (17) Освобождает выделенную память
+// (19) Возвращает длину плоскостей (с дополнением)
+int32_t Field::getPlaneLength() const
+{
+    return length_;
+}
+
+// (20) Плоскость значений клеток
+const int16_t* Field::getIndexPlane() const
+{
+    return index_;
+}
+
+// (21) Плоскость "id" путей
+const int16_t* Field::getIdPlane() const
+{
+    return id_;
+}
+
+// (22) Плоскость порядковых номеров в пути
+const int16_t* Field::getNumPlane() const
+{
+    return num_;
+}
+
+// (33) Освобождает выделенную память
 void Field::clear()
 {
-    if (cells_ != nullptr)
+    if (index_ != nullptr)
     {
-        for (int i = 0; i < sizeX_; ++i)
-        {
-            if (cells_[i] != nullptr)
-            {
-                delete[] cells_[i];
-            }
-        }
-        delete[] cells_;
-        cells_ = nullptr;
+        ::operator delete(index_, std::align_val_t(CELLS_ALIGNMENT));
     }
-    sizeX_ = 0;
-    sizeY_ = 0;
+    index_  = nullptr;
+    id_     = nullptr;
+    num_    = nullptr;
+    way_    = nullptr;
+    length_ = 0;
+    stride_ = 0;
+    sizeX_  = 0;
+    sizeY_  = 0;
 }
 
-// (18) Деструктор
+// (34) Деструктор
 Field::~Field()
 {
     clear();
 }
 
-////////// class TrackSeq ////////////////////////////////////////////////////
-// Описание : instrumentslib.h                                              //
-//////////////////////////////////////////////////////////////////////////////
-
-// (1) Конструктор (обнуляет поля)
-TrackSeq::TrackSeq()
-{
-    number_ = 0;
-}
+////////// private ///////////////////////////////////////////////////////////
 
-// (4) Сгенерировать новую случайную последовательность
-void TrackSeq::regenerate()
+// (2) Заполняет рамку поля "стеной"
+void Field::buildWalls()
 {
-    int16_t temp    = 0;
-    bool    isEqual = false;
-    
-    // Задать нужный размер
-    number_ = 0;
-    if (seq_.size() != 4)
+    // Верхняя и нижняя строки рамки
+    for (int32_t i = 0; i < stride_; ++i)
     {
-        seq_.resize(4);
+        id_[i]                          = WALL_ID;
+        id_[(sizeY_ + 1) * stride_ + i] = WALL_ID;
     }
     
-    // Заполнить вектор случайной перестановкой из {0, 1, 2, 3}
-    while (number_ < 4)
+    // Левый и правый столбцы рамки
+    for (int32_t j = 1; j <= sizeY_; ++j)
     {
-        temp = rand() % 4;
-        isEqual = false;
-        for (int i = 0; i < number_ && !isEqual; ++i)
-        {
-            isEqual = seq_[i] == temp;
-        }
-        if (!isEqual)
-        {
-            seq_[number_] = temp;
-            ++number_;
-        }
+        id_[j * stride_]               = WALL_ID;
+        id_[j * stride_ + stride_ - 1] = WALL_ID;
     }
-    number_ = 0;
 }
 
-// (5) Возвращает "true", если использовали все варианты сдвига
-bool TrackSeq::haveFinished() const
+////////// class TrackSeq ////////////////////////////////////////////////////
+// Описание : instrumentslib.h                                              //
+//////////////////////////////////////////////////////////////////////////////
+
+// (1) Конструктор (обнуляет поля)
+TrackSeq::TrackSeq()
 {
-    return number_ == 4;
+    clear();
 }
 
 // (6) Вернуть позицию после очередного сдвига (через Vector)
@@ -406,41 +719,22 @@ Vector TrackSeq::getVector(int16_t x, int16_t y)
 {
     Vector temp(x, y);
     
-    // Произвести соответствующий сдвиг
-    if (number_ < 4 && seq_.size() == 4)
+    // Произвести соответствующий сдвиг (по таблице)
+    if (number_ < 4)
     {
-        switch (seq_[number_])
-        {
-            case 0 :
-                --temp.x;
-                break;
-            
-            case 1 :
-                ++temp.x;
-                break;
-            
-            case 2 :
-                ++temp.y;
-                break;
-            
-            case 3 :
-                --temp.y;
-                break;
-            
-            default :
-                throw err::PcsException(1);
-                break;
-        }
-        ++number_;
+        int16_t dir = getShiftCode();
+        
+        temp.x += SHIFT_X[dir];
+        temp.y += SHIFT_Y[dir];
     }
     return temp;
 }
 
-// (8) Обнуляет поля, освобождает выделенную память
+// (9) Обнуляет поля
 void TrackSeq::clear()
 {
-    number_ = 0;
-    seq_.clear();
+    perm_   = 0;
+    number_ = 4;
 }
 
 ////////// struct Area ///////////////////////////////////////////////////////
@@ -478,4 +772,35 @@ void Area::clear()
     maxX = 0;
     minY = 0;
     maxY = 0;
+}
+
+////////// struct Region /////////////////////////////////////////////////////
+// Описание : instrumentslib.h                                              //
+//////////////////////////////////////////////////////////////////////////////
+
+// (6) Проверка корректности области
+bool Region::isCorrect() const
+{
+    return box.isCorrect() && minX.size() == box.maxY - box.minY + 1 &&
+                              maxX.size() == box.maxY - box.minY + 1;
+}
+
+// (7) Возвращает кол-во клеток области
+int32_t Region::getCellNumber() const
+{
+    int32_t number = 0;
+    
+    for (int16_t i = 0; i < minX.size(); ++i)
+    {
+        number += max(0, maxX[i] - minX[i] + 1);
+    }
+    return number;
+}
+
+// (8) Обнуляет поля, освобождает выделенную память
+void Region::clear()
+{
+    box.clear();
+    minX.clear();
+    maxX.clear();
 }
\ No newline at end of file
@@ -0,0 +1,686 @@
+////////// parallellib ///////////////////////////////////////////////////////
+// Автор    : Баталов Семен                                                 //
+// Дата     : 08.11.2020                                                    //
+// Описание : Здесь представлены инструменты для параллельного решения      //
+//            филиппинского кроссворда (пул потоков, "портфель"             //
+//            независимых решателей, решение по частям и по повторяющимся   //
+//            блокам, пакетное решение набора полей).                       //
+//////////////////////////////////////////////////////////////////////////////
+
+#include "parallellib.h"
+
+#include <chrono>
+
+using namespace pcs;
+
+////////// getCoreNumber /////////////////////////////////////////////////////
+// Описание : parallellib.h                                                 //
+//////////////////////////////////////////////////////////////////////////////
+
+int16_t pcs::getCoreNumber()
+{
+    return max(1, std::thread::hardware_concurrency());
+}
+
+////////// class ThreadPool //////////////////////////////////////////////////
+// Описание : parallellib.h                                                 //
+//////////////////////////////////////////////////////////////////////////////
+
+////////// public ////////////////////////////////////////////////////////////
+
+// (1) Конструктор (запускает "nThreads" потоков)
+ThreadPool::ThreadPool(int16_t nThreads)
+{
+    nActive_   = 0;
+    isStopped_ = false;
+    
+    for (int16_t i = 0; i < max(1, nThreads); ++i)
+    {
+        workers_.emplace_back(&ThreadPool::work, this);
+    }
+}
+
+// (4) Ставит задачу в очередь
+void ThreadPool::submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push(std::move(task));
+    }
+    haveTask_.notify_one();
+}
+
+// (5) Ждет выполнения всех задач
+void ThreadPool::wait()
+{
+    std::exception_ptr error;
+    
+    // Ждем, пока очередь опустеет и все потоки освободятся
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        haveDone_.wait(lock, [this] {
+            return tasks_.empty() && nActive_ == 0;
+        });
+        error  = error_;
+        error_ = nullptr;
+    }
+    
+    // Передаем исключение из задачи вызывающему
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+// (6) Возвращает кол-во потоков
+int16_t ThreadPool::getThreadNumber() const
+{
+    return workers_.size();
+}
+
+// (7) Деструктор (дожидается потоков)
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        isStopped_ = true;
+    }
+    haveTask_.notify_all();
+    
+    for (int16_t i = 0; i < workers_.size(); ++i)
+    {
+        workers_[i].join();
+    }
+}
+
+////////// private ///////////////////////////////////////////////////////////
+
+// (1) Цикл работы потока
+void ThreadPool::work()
+{
+    std::function<void()> task;
+    
+    while (true)
+    {
+        // Берем задачу из очереди (или завершаемся)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            haveTask_.wait(lock, [this] {
+                return isStopped_ || !tasks_.empty();
+            });
+            if (tasks_.empty())
+            {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop();
+            ++nActive_;
+        }
+        
+        // Выполняем задачу, запоминаем первое исключение
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_)
+            {
+                error_ = std::current_exception();
+            }
+        }
+        
+        // Сообщаем о выполнении
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --nActive_;
+        }
+        haveDone_.notify_all();
+    }
+}
+
+////////// class Portfolio ///////////////////////////////////////////////////
+// Описание : parallellib.h                                                 //
+//////////////////////////////////////////////////////////////////////////////
+
+// (1) Конструктор
+Portfolio::Portfolio() : stop_(false)
+{
+    seed_       = 0;
+    winnerSeed_ = 0;
+    status_     = TIMEOUT;
+    nThreads_   = getCoreNumber();
+}
+
+// (4) Задает кол-во решателей
+void Portfolio::setThreadNumber(int16_t nThreads)
+{
+    nThreads_ = max(1, nThreads);
+}
+
+// (5) Задает базовое зерно
+void Portfolio::setSeed(uint64_t seed)
+{
+    seed_ = seed;
+}
+
+// (6) Задает решатель - образец настроек
+void Portfolio::setPrototype(const Solver& solver)
+{
+    proto_ = solver;
+}
+
+// (7) Задает обработчик хода решения (пустой - без индикации)
+void Portfolio::setProgress(const std::function<void(int32_t, int16_t)>&
+                            progress)
+{
+    progress_ = progress;
+}
+
+// (8) Решает поле "field" (если это удается)
+void Portfolio::solve(const Field& field, bool& wasSolved)
+{
+    ThreadPool pool(nThreads_);
+    
+    // Предварительная инициализация
+    wasSolved = false;
+    stop_     = false;
+    status_   = TIMEOUT;
+    result_.clear();
+    stats_.clear();
+    
+    // Независимые решатели с настройками образца и разными зернами
+    for (int16_t k = 0; k < nThreads_; ++k)
+    {
+        pool.submit([this, &field, &wasSolved, k] {
+            Solver solver(proto_);
+            bool   isSolved = false;
+            
+            solver.setField(field);
+            solver.setSeed(seed_ + k);
+            solver.setStopFlag(&stop_);
+            
+            // Ход решения сообщает только первый решатель (иначе вывод
+            // потоков перемешивается)
+            if (k == 0)
+            {
+                solver.setProgress(progress_);
+            }
+            else
+            {
+                solver.setProgress({});
+            }
+            solver.prepare();
+            solver.solve(isSolved);
+            
+            // Первый решивший останавливает остальных
+            bool isWinner = isSolved && !stop_.exchange(true);
+            
+            if (isWinner)
+            {
+                solver.setDirections();
+            }
+            
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.add(solver.getStats());
+            if (isWinner)
+            {
+                solver.getField(result_);
+                winnerSeed_ = seed_ + k;
+                status_     = SOLVED;
+                wasSolved   = true;
+            }
+            else
+            if (solver.getStatus() == UNSOLVABLE && status_ != SOLVED)
+            {
+                // Решения нет - остальным искать нечего
+                stop_   = true;
+                status_ = UNSOLVABLE;
+            }
+        });
+    }
+    pool.wait();
+}
+
+// (9) Копирует решение в "field"
+void Portfolio::getField(Field& field) const
+{
+    field = result_;
+}
+
+// (10) Возвращает зерно решателя, нашедшего решение
+uint64_t Portfolio::getWinnerSeed() const
+{
+    return winnerSeed_;
+}
+
+// (11) Возвращает итог решения
+SolveStatus Portfolio::getStatus() const
+{
+    return status_;
+}
+
+// (12) Возвращает сумму статистик решателей
+const SolverStats& Portfolio::getStats() const
+{
+    return stats_;
+}
+
+////////// class Decomposer //////////////////////////////////////////////////
+// Описание : parallellib.h                                                 //
+//////////////////////////////////////////////////////////////////////////////
+
+////////// public ////////////////////////////////////////////////////////////
+
+// (1) Конструктор
+Decomposer::Decomposer() : stop_(false)
+{
+    seed_     = 0;
+    status_   = TIMEOUT;
+    nThreads_ = getCoreNumber();
+}
+
+// (4) Задает кол-во потоков
+void Decomposer::setThreadNumber(int16_t nThreads)
+{
+    nThreads_ = max(1, nThreads);
+}
+
+// (5) Задает базовое зерно
+void Decomposer::setSeed(uint64_t seed)
+{
+    seed_ = seed;
+}
+
+// (6) Разбивает поле решателя "solver" на части
+void Decomposer::split(const Solver& solver)
+{
+    proto_ = solver;
+    proto_.splitField(parts_);
+    
+    // Слитое решение начинается с чистого поля
+    proto_.getField(result_);
+    result_.refresh();
+}
+
+// (7) Возвращает кол-во частей
+int16_t Decomposer::getPartNumber() const
+{
+    return parts_.size();
+}
+
+// (8) Решает все части (если это удается)
+void Decomposer::solve(bool& wasSolved)
+{
+    ThreadPool pool(min(nThreads_, max(1, parts_.size())));
+    
+    // Предварительная инициализация
+    stop_   = false;
+    status_ = SOLVED;
+    stats_.clear();
+    
+    // Каждая часть - свой решатель с настройками образца
+    for (int16_t k = 0; k < parts_.size(); ++k)
+    {
+        pool.submit([this, k] {
+            Solver      solver(proto_);
+            SolveStatus status   = UNSOLVABLE;
+            bool        isSolved = false;
+            
+            // Часть с непарными клетками решения не имеет
+            solver.setField(parts_[k]);
+            if (solver.isCorrectField())
+            {
+                solver.setSeed(seed_ + k);
+                solver.setStopFlag(&stop_);
+                solver.setProgress({}); // Части решаются параллельно
+                solver.prepare();
+                solver.solve(isSolved);
+                status = solver.getStatus();
+            }
+            
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (isSolved)
+            {
+                solver.setDirections();
+                solver.getField(parts_[k]);
+                merge(parts_[k]);
+            }
+            else
+            {
+                // Без этой части решения нет - останавливаем остальные
+                stop_ = true;
+                if (status_ != UNSOLVABLE)
+                {
+                    status_ = status;
+                }
+            }
+            stats_.add(solver.getStats());
+        });
+    }
+    pool.wait();
+    wasSolved = (status_ == SOLVED);
+}
+
+// (9) Копирует слитое решение в "field"
+void Decomposer::getField(Field& field) const
+{
+    field = result_;
+}
+
+// (10) Возвращает итог решения (худший по частям)
+SolveStatus Decomposer::getStatus() const
+{
+    return status_;
+}
+
+// (11) Возвращает сумму статистик решателей частей
+const SolverStats& Decomposer::getStats() const
+{
+    return stats_;
+}
+
+////////// private ///////////////////////////////////////////////////////////
+
+// (1) Переносит пути решенной части "part" в "result_"
+void Decomposer::merge(const Field& part)
+{
+    // Клетки других частей в "part" заменены единицами - их пропускаем
+    for (int16_t y = 0; y < result_.getSizeY(); ++y)
+    {
+        for (int16_t x = 0; x < result_.getSizeX(); ++x)
+        {
+            Cell cell = part(x, y);
+            
+            if (cell.id != 0 && cell.index == result_(x, y).index &&
+                result_(x, y).id == 0)
+            {
+                result_(x, y) = cell;
+            }
+        }
+    }
+}
+
+////////// class Stamper /////////////////////////////////////////////////////
+// Описание : parallellib.h                                                 //
+//////////////////////////////////////////////////////////////////////////////
+
+////////// public ////////////////////////////////////////////////////////////
+
+// (1) Конструктор
+Stamper::Stamper()
+{
+    seed_     = 0;
+    status_   = TIMEOUT;
+    nThreads_ = getCoreNumber();
+}
+
+// (4) Задает кол-во потоков
+void Stamper::setThreadNumber(int16_t nThreads)
+{
+    nThreads_ = max(1, nThreads);
+}
+
+// (5) Задает базовое зерно
+void Stamper::setSeed(uint64_t seed)
+{
+    seed_ = seed;
+}
+
+// (6) Ищет повторяющиеся блоки поля решателя "solver"
+void Stamper::split(const Solver& solver)
+{
+    proto_ = solver;
+    proto_.findBlocks(blocks_, copies_);
+    proto_.getField(source_);
+    source_.refresh();
+}
+
+// (7) Возвращает кол-во различных блоков
+int16_t Stamper::getBlockNumber() const
+{
+    return blocks_.size();
+}
+
+// (8) Возвращает кол-во копий всех блоков
+int32_t Stamper::getCopyNumber() const
+{
+    int32_t nCopies = 0;
+    
+    for (int16_t k = 0; k < copies_.size(); ++k)
+    {
+        nCopies += copies_[k].size();
+    }
+    return nCopies;
+}
+
+// (9) Решает блоки и остаток поля (если это удается)
+void Stamper::solve(bool& wasSolved)
+{
+    Solver solver(proto_);
+    Field  rest(source_);
+    
+    // Каждый блок - свой решатель (нерешенный блок остается в остатке)
+    isSolved_.assign(blocks_.size(), false);
+    stats_.clear();
+    {
+        ThreadPool pool(min(nThreads_, max(1, blocks_.size())));
+        
+        for (int16_t k = 0; k < blocks_.size(); ++k)
+        {
+            pool.submit([this, k] {
+                Solver solver(proto_);
+                bool   isSolved = false;
+                
+                solver.setField(blocks_[k]);
+                if (solver.isCorrectField())
+                {
+                    solver.setSeed(seed_ + k);
+                    solver.setProgress({}); // Блоки решаются параллельно
+                    solver.prepare();
+                    solver.solve(isSolved);
+                }
+                if (isSolved)
+                {
+                    solver.setDirections();
+                    solver.getField(blocks_[k]);
+                    isSolved_[k] = true;
+                }
+                
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.add(solver.getStats());
+            });
+        }
+        pool.wait();
+    }
+    
+    // В остатке клетки путей решенных блоков становятся единицами
+    // (закрытые в блоке клетки остаются пустыми)
+    for (int16_t k = 0; k < blocks_.size(); ++k)
+    {
+        for (int32_t c = 0; c < copies_[k].size() && isSolved_[k]; ++c)
+        {
+            const Vector corner = copies_[k][c];
+            
+            for (int16_t y = 0; y < blocks_[k].getSizeY(); ++y)
+            {
+                for (int16_t x = 0; x < blocks_[k].getSizeX(); ++x)
+                {
+                    Cell cell = blocks_[k](x, y);
+                    
+                    if (cell.id != 0 && cell.index ==
+                        source_(corner.x + x, corner.y + y).index)
+                    {
+                        rest(corner.x + x, corner.y + y).index = 1;
+                    }
+                }
+            }
+        }
+    }
+    
+    // Остаток решается обычным решателем
+    wasSolved = false;
+    status_   = UNSOLVABLE;
+    solver.setField(rest);
+    if (solver.isCorrectField())
+    {
+        solver.setSeed(seed_ + blocks_.size());
+        solver.prepare();
+        solver.solve(wasSolved);
+        status_ = solver.getStatus();
+    }
+    if (wasSolved)
+    {
+        solver.setDirections();
+        solver.getField(result_);
+        for (int16_t k = 0; k < blocks_.size(); ++k)
+        {
+            for (int32_t c = 0; c < copies_[k].size() && isSolved_[k]; ++c)
+            {
+                stamp(k, copies_[k][c]);
+            }
+        }
+    }
+    stats_.add(solver.getStats());
+}
+
+// (10) Копирует решение в "field"
+void Stamper::getField(Field& field) const
+{
+    field = result_;
+}
+
+// (11) Возвращает итог решения
+SolveStatus Stamper::getStatus() const
+{
+    return status_;
+}
+
+// (12) Возвращает сумму статистик решателей блоков и остатка
+const SolverStats& Stamper::getStats() const
+{
+    return stats_;
+}
+
+////////// private ///////////////////////////////////////////////////////////
+
+// (1) Впечатывает решение блока "block" в копию с углом "corner"
+void Stamper::stamp(int16_t block, Vector corner)
+{
+    const Field&  source = blocks_[block];
+    const int16_t sizeX  = source.getSizeX();
+    
+    for (int16_t y = 0; y < source.getSizeY(); ++y)
+    {
+        for (int16_t x = 0; x < sizeX; ++x)
+        {
+            Cell cell = source(x, y);
+            
+            // "id" - "protoId" начала пути, он пересчитывается в
+            // координаты поля (закрытые в блоке клетки пропускаем)
+            if (cell.id != 0 &&
+                cell.index == source_(corner.x + x, corner.y + y).index)
+            {
+                cell.id = result_(corner.x + (cell.id - 1) % sizeX,
+                                  corner.y + (cell.id - 1) / sizeX).protoId;
+                result_(corner.x + x, corner.y + y) = cell;
+            }
+        }
+    }
+}
+
+
+////////// struct BatchTask //////////////////////////////////////////////////
+// Описание : parallellib.h                                                 //
+//////////////////////////////////////////////////////////////////////////////
+
+// (1) Конструктор (обнуляет поля)
+BatchTask::BatchTask()
+{
+    clear();
+}
+
+// (4) Обнуляет итог решения
+void BatchTask::clear()
+{
+    error.clear();
+    isCorrect = false;
+    wasSolved = false;
+    time      = 0;
+    sweeps    = 0;
+    restarts  = 0;
+}
+
+////////// solveBatch ////////////////////////////////////////////////////////
+// Описание : parallellib.h                                                 //
+//////////////////////////////////////////////////////////////////////////////
+
+void pcs::solveBatch(std::vector<BatchTask>& tasks, const Solver& proto,
+                     int16_t nThreads, uint64_t seed)
+{
+    ThreadPool           pool(min(max(1, nThreads), max(1, tasks.size())));
+    std::atomic<int32_t> next(0);
+    
+    // Каждый поток берет очередное поле, пока они не закончатся
+    for (int16_t k = 0; k < pool.getThreadNumber(); ++k)
+    {
+        pool.submit([&tasks, &next, &proto, seed] {
+            Solver  solver(proto);
+            Field   field;
+            
+            // Потоки пакета хода решения не сообщают
+            solver.setProgress({});
+            for (int32_t i = next++; i < tasks.size(); i = next++)
+            {
+                BatchTask& task  = tasks[i];
+                auto       time1 = std::chrono::steady_clock::now();
+                
+                task.clear();
+                try
+                {
+                    // Читаем поле из файла
+                    std::ifstream inFile(task.inName);
+                    rwc::scanf(inFile, field);
+                    inFile.close();
+                    
+                    // Решаем тем же объектом "Solver"
+                    solver.setField(field);
+                    task.isCorrect = solver.isCorrectField();
+                    if (task.isCorrect)
+                    {
+                        solver.setSeed(seed);
+                        solver.prepare();
+                        solver.solve(task.wasSolved);
+                        task.sweeps   = solver.getSweepNumber();
+                        task.restarts = solver.getRestartNumber();
+                    }
+                    
+                    // Записываем решение
+                    if (task.wasSolved)
+                    {
+                        std::ofstream outFile(task.outName);
+                        
+                        solver.setDirections();
+                        solver.getField(field);
+                        rwc::printf(outFile, field);
+                    }
+                }
+                catch (const err::Exception& ex)
+                {
+                    task.error  = ex.what();
+                    task.error += " (" + std::to_string(ex.error()) + ")";
+                }
+                catch (const std::exception& ex)
+                {
+                    task.error = ex.what();
+                }
+                
+                std::chrono::duration<float> time;
+                time      = std::chrono::steady_clock::now() - time1;
+                task.time = time.count();
+            }
+        });
+    }
+    pool.wait();
+}
\ No newline at end of file
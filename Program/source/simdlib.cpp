@@ -0,0 +1,150 @@
+////////// simdlib ///////////////////////////////////////////////////////////
+// Автор    : Баталов Семен                                                 //
+// Дата     : 08.11.2020                                                    //
+// Описание : Здесь представлены векторные (SSE2/AVX2) процедуры просмотра  //
+//            плоскостей поля кроссворда. Если набор инструкций недоступен, //
+//            используется скалярная реализация.                            //
+//////////////////////////////////////////////////////////////////////////////
+
+#include "simdlib.h"
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+////////// anyNonZero ////////////////////////////////////////////////////////
+// Описание : simdlib.h                                                     //
+//////////////////////////////////////////////////////////////////////////////
+
+bool simd::anyNonZero(const int16_t* plane, int32_t n)
+{
+    int32_t k = 0;
+    
+#if defined(__AVX2__)
+    for (; k + 16 <= n; k += 16)
+    {
+        __m256i v = _mm256_loadu_si256((const __m256i*) (plane + k));
+        if (!_mm256_testz_si256(v, v))
+        {
+            return true;
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; k + 8 <= n; k += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*) (plane + k));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(v, zero)) != 0xFFFF)
+        {
+            return true;
+        }
+    }
+#endif
+    
+    // Оставшиеся элементы
+    for (; k < n; ++k)
+    {
+        if (plane[k] != 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+////////// allInRange ////////////////////////////////////////////////////////
+// Описание : simdlib.h                                                     //
+//////////////////////////////////////////////////////////////////////////////
+
+bool simd::allInRange(const int16_t* plane, int32_t n, int16_t low,
+                      int16_t high)
+{
+    int32_t k = 0;
+    
+#if defined(__AVX2__)
+    const __m256i vLow  = _mm256_set1_epi16(low);
+    const __m256i vHigh = _mm256_set1_epi16(high);
+    for (; k + 16 <= n; k += 16)
+    {
+        __m256i v   = _mm256_loadu_si256((const __m256i*) (plane + k));
+        __m256i out = _mm256_or_si256(_mm256_cmpgt_epi16(vLow, v),
+                                      _mm256_cmpgt_epi16(v, vHigh));
+        if (!_mm256_testz_si256(out, out))
+        {
+            return false;
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128i vLow  = _mm_set1_epi16(low);
+    const __m128i vHigh = _mm_set1_epi16(high);
+    for (; k + 8 <= n; k += 8)
+    {
+        __m128i v   = _mm_loadu_si128((const __m128i*) (plane + k));
+        __m128i out = _mm_or_si128(_mm_cmplt_epi16(v, vLow),
+                                   _mm_cmpgt_epi16(v, vHigh));
+        if (_mm_movemask_epi8(out) != 0)
+        {
+            return false;
+        }
+    }
+#endif
+    
+    // Оставшиеся элементы
+    for (; k < n; ++k)
+    {
+        if (plane[k] < low || plane[k] > high)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+////////// countFree /////////////////////////////////////////////////////////
+// Описание : simdlib.h                                                     //
+//////////////////////////////////////////////////////////////////////////////
+
+int32_t simd::countFree(const int16_t* index, const int16_t* id, int32_t n,
+                        int16_t threshold)
+{
+    int32_t k     = 0;
+    int32_t count = 0;
+    
+#if defined(__AVX2__)
+    const __m256i vThr  = _mm256_set1_epi16(threshold);
+    const __m256i zero  = _mm256_setzero_si256();
+    for (; k + 16 <= n; k += 16)
+    {
+        __m256i vIndex = _mm256_loadu_si256((const __m256i*) (index + k));
+        __m256i vId    = _mm256_loadu_si256((const __m256i*) (id + k));
+        __m256i match  = _mm256_and_si256(_mm256_cmpgt_epi16(vIndex, vThr),
+                                          _mm256_cmpeq_epi16(vId, zero));
+        
+        // На каждый подходящий элемент приходится два бита маски
+        count += __builtin_popcount(_mm256_movemask_epi8(match)) / 2;
+    }
+#elif defined(__SSE2__)
+    const __m128i vThr  = _mm_set1_epi16(threshold);
+    const __m128i zero  = _mm_setzero_si128();
+    for (; k + 8 <= n; k += 8)
+    {
+        __m128i vIndex = _mm_loadu_si128((const __m128i*) (index + k));
+        __m128i vId    = _mm_loadu_si128((const __m128i*) (id + k));
+        __m128i match  = _mm_and_si128(_mm_cmpgt_epi16(vIndex, vThr),
+                                       _mm_cmpeq_epi16(vId, zero));
+        
+        // На каждый подходящий элемент приходится два бита маски
+        count += __builtin_popcount(_mm_movemask_epi8(match)) / 2;
+    }
+#endif
+    
+    // Оставшиеся элементы
+    for (; k < n; ++k)
+    {
+        if (index[k] > threshold && id[k] == 0)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
@@ -9,6 +9,66 @@
 
 using namespace pcs;
 
+////////// struct SolveResult ////////////////////////////////////////////////
+// Описание : solvelib.h                                                    //
+//////////////////////////////////////////////////////////////////////////////
+
+// (1) Конструктор (обнуляет поля)
+SolveResult::SolveResult()
+{
+    status      = TIMEOUT;
+    time        = 0;
+    nIterations = 0;
+    nMisPaths   = 0;
+}
+
+////////// struct SolverStats ////////////////////////////////////////////////
+// Описание : solvelib.h                                                    //
+//////////////////////////////////////////////////////////////////////////////
+
+// (1) Конструктор (обнуляет поля)
+SolverStats::SolverStats()
+{
+    clear();
+}
+
+// (4) Прибавляет статистику "stats"
+void SolverStats::add(const SolverStats& stats)
+{
+    nSweeps       += stats.nSweeps;
+    nPathCalls    += stats.nPathCalls;
+    nWalkSteps    += stats.nWalkSteps;
+    nCycleCaps    += stats.nCycleCaps;
+    nBacktracks   += stats.nBacktracks;
+    nRipUps       += stats.nRipUps;
+    nRestarts     += stats.nRestarts;
+    prepareTime   += stats.prepareTime;
+    solveTime     += stats.solveTime;
+    directionTime += stats.directionTime;
+    for (int16_t i = 0; i <= MAX_INDEX; ++i)
+    {
+        nBuilt[i]   += stats.nBuilt[i];
+        nDeleted[i] += stats.nDeleted[i];
+    }
+}
+
+// (5) Обнуляет статистику
+void SolverStats::clear()
+{
+    nSweeps       = 0;
+    nPathCalls    = 0;
+    nWalkSteps    = 0;
+    nCycleCaps    = 0;
+    nBacktracks   = 0;
+    nRipUps       = 0;
+    nRestarts     = 0;
+    prepareTime   = 0;
+    solveTime     = 0;
+    directionTime = 0;
+    nBuilt.assign(MAX_INDEX + 1, 0);
+    nDeleted.assign(MAX_INDEX + 1, 0);
+}
+
 ////////// class Solver //////////////////////////////////////////////////////
 // Описание : solvelib.h                                                    //
 //////////////////////////////////////////////////////////////////////////////
@@ -18,14 +78,47 @@ using namespace pcs;
 // (1) Конструктор (обнуляет поля)
 Solver::Solver()
 {
-    nAreas_   = 0;
-    nId_      = 0;
+    nAreas_     = 0;
+    nId_        = 0;
+    nSweeps_    = 0;
+    nMisPoints_ = 0;
+    nCovered_   = 0;
+    hash_       = 0;
+    stop_       = nullptr;
+    finish_     = std::chrono::steady_clock::time_point::max();
+    engine_     = RANDOM_WALK;
+    status_     = TIMEOUT;
+    timeLimit_  = BACKTRACK_TIME_LIMIT;
+    nStamp_     = 0;
+    nNodes_     = 0;
+    nPairPaths_ = 0;
+    nChanges_   = 0;
+    nTilesX_    = 0;
+    nTabu_      = 0;
+    nRestarts_  = 0;
+    
+    bestMisPoints_ = 0;
+    bestCovered_   = 0;
+    bestHash_      = 0;
+    restartPolicy_ = RESTART_LUBY;
+    restartAction_ = RESHUFFLE;
+    restartBase_   = RESTART_BASE;
+    orderPolicy_   = ORDER_RANDOM;
+    tableMemory_   = TABLE_MEMORY;
+    conflictInc_   = 1;
+    havePartners_  = false;
+    isStatsOn_     = false;
+    isInterrupted_ = false;
+    isOverflow_    = false;
+    isWalking_     = false;
 }
 
 // (4) Инициализирует поле кроссворда
 void Solver::setField(const Field& map)
 {
-    map_ = map;
+    map_          = map;
+    havePartners_ = false;
+    stats_.clear();
 }
 
 // (5) Возвращает поле
@@ -42,7 +135,14 @@ bool Solver::isCorrectField()
     bool isNormIndex = map_.isCorrectIndex();
     bool isNotEmpty  = !(map_.isEmpty());
     bool isNormNum   = isCorrectNumber();
-    bool isNormRel   = isCorrectRelations();
+    bool isNormRel   = false;
+    
+    // Списки пар нужны и для проверки, и для решения
+    if (isNormSize && isNormIndex)
+    {
+        createPartners();
+        isNormRel = isCorrectRelations();
+    }
     
     // Для дальнейшей работы необходимо выполнение всех условий
     return isNormSize && isNormIndex && isNormNum && isNotEmpty && isNormRel;
@@ -51,22 +151,19 @@ bool Solver::isCorrectField()
 // (7) Подготавливает поле
 void Solver::prepare()
 {
-    Vector  iPoint;
-    int16_t nPoints = 0;
+    Vector iPoint;
+    auto   start = std::chrono::steady_clock::now();
+    
+    // Статистика ведется с подготовки поля
+    stats_.clear();
     
     // Оставляем на поле только индексы
     map_.refresh();
     
-    // Считаем кол-во нетривиальных клеток на поле
-    for (iPoint.y = 0; iPoint.y < map_.getSizeY(); ++iPoint.y)
+    // Нетривиальные клетки и их пары (если еще не найдены при проверке)
+    if (!havePartners_)
     {
-        for (iPoint.x = 0; iPoint.x < map_.getSizeX(); ++iPoint.x)
-        {
-            if (map_(iPoint).index > 2)
-            {
-                ++nPoints;
-            }
-        }
+        createPartners();
     }
     
     // Задаем размеры хранилищ
@@ -78,18 +175,75 @@ void Solver::prepare()
             track_.resize(MAX_INDEX + 1);
         }
         
-        // Хранилище прошлых позиций
-        if (path_.size() != MAX_INDEX + 1)
+        // Рабочие массивы (память сохраняется)
+        idArray_.resize(points_.size() / 2);
+        ripWeights_.resize(points_.size() / 2);
+        
+        // Штрафы конфликтов и список запретов
+        idConflict_.assign(points_.size(), 0);
+        cellConflict_.assign(map_.getPlaneLength(), 0);
+        tabu_.assign(TABU_LENGTH, 0);
+        conflictInc_ = 1;
+        nTabu_       = 0;
+        
+        // Массивы обхода в ширину (для перебора и карт расстояний)
+        stamp_.assign(map_.getPlaneLength(), 0);
+        depth_.assign(map_.getPlaneLength(), 0);
+        queue_.resize(map_.getPlaneLength());
+        nStamp_ = 0;
+        
+        // Карты расстояний пар (все пока не построены)
+        distStart_.resize(partners_.size() + 1);
+        distStart_[0] = 0;
+        for (int32_t k = 0; k < partners_.size(); ++k)
+        {
+            const Area& area = partnerRegions_[k].box;
+            
+            distStart_[k + 1] = distStart_[k] + (area.maxX - area.minX + 1) *
+                                                (area.maxY - area.minY + 1);
+        }
+        distCells_.resize(distStart_[partners_.size()]);
+        distVersion_.assign(partners_.size(), -1);
+        
+        // Плитки поля
+        nTilesX_ = ((map_.getSizeX() - 1) >> DIST_TILE_SHIFT) + 1;
+        tileStamp_.assign(nTilesX_ *
+                          (((map_.getSizeY() - 1) >> DIST_TILE_SHIFT) + 1), 0);
+        tileByPos_.assign(map_.getPlaneLength(), 0);
+        for (iPoint.y = 0; iPoint.y < map_.getSizeY(); ++iPoint.y)
+        {
+            for (iPoint.x = 0; iPoint.x < map_.getSizeX(); ++iPoint.x)
+            {
+                tileByPos_[map_.getPos(iPoint)] =
+                    (iPoint.y >> DIST_TILE_SHIFT) * nTilesX_ +
+                    (iPoint.x >> DIST_TILE_SHIFT);
+            }
+        }
+        nChanges_ = 0;
+        
+        // Рабочие массивы
+        candidates_.clear();
+        order_.clear();
+        for (int16_t i = 0; i < points_.size(); ++i)
         {
-            path_.resize(MAX_INDEX + 1);
+            order_.push_back(i);
         }
+        orderScore_.resize(points_.size());
+        createOrderKeys();
         
-        // Хранилище нетривиальных клеток
-        if (points_.size() != nPoints)
+        // Ключи Зобриста клеток и путей (ключи путей нечетные, поэтому
+        // произведение с ключом клетки не теряет младших битов)
+        Random keys(ZOBRIST_SEED);
+        
+        zobristCell_.resize(map_.getPlaneLength());
+        for (int32_t pos = 0; pos < zobristCell_.size(); ++pos)
+        {
+            zobristCell_[pos] = keys.next();
+        }
+        zobristId_.assign(slotById_.size(), 0);
+        for (int16_t i = 0; i < points_.size(); ++i)
         {
-            idArray_.resize(nPoints / 2);
-            points_.resize(0);
-            areas_.resize(nPoints);
+            zobristId_[map_(points_[i]).protoId] = keys.next() | 1;
         }
     }
     catch (...)
@@ -98,7 +252,7 @@ void Solver::prepare()
         throw;
     }
     
-    // Проходим по всему полю, записываем клетки с цифрами > 2
+    // Клетки с 1 и 2 заняты сразу
     for (iPoint.y = 0; iPoint.y < map_.getSizeY(); ++iPoint.y)
     {
         for (iPoint.x = 0; iPoint.x < map_.getSizeX(); ++iPoint.x)
@@ -107,411 +261,2397 @@ void Solver::prepare()
             {
                 map_(iPoint).id = map_(iPoint).protoId;
             }
-            else
-            if (map_(iPoint).index > 0)
-            {
-                points_.push_back(iPoint);
-            }
         }
     }
+    
+    // Все нетривиальные клетки пока свободны
+    nMisPoints_ = simd::countFree(map_.getIndexPlane(), map_.getIdPlane(),
+                                  map_.getPlaneLength(), 2);
+    nCovered_   = 0;
+    hash_       = 0;
+    
+    // Выделяем каждой нетривиальной клетке блок "index" клеток пути
+    try
+    {
+        pathStart_.resize(points_.size() + 1);
+        pathLength_.assign(points_.size(), 0);
+        
+        pathStart_[0] = 0;
+        for (int16_t i = 0; i < points_.size(); ++i)
+        {
+            pathStart_[i + 1] = pathStart_[i] + map_(points_[i]).index;
+        }
+        pathCells_.resize(pathStart_[points_.size()]);
+    }
+    catch (...)
+    {
+        clear();
+        throw;
+    }
+    stats_.prepareTime = std::chrono::duration<float>(
+                             std::chrono::steady_clock::now() - start).count();
 }
 
 // (8) Разводит пути на поле (если это удается)
 void Solver::solve(bool& wasSolved)
 {
+    // Срока нет : движки ограничены только своими лимитами
+    solve(std::chrono::steady_clock::time_point::max());
+    wasSolved = (status_ == SOLVED);
+}
+
+// (9) Разводит пути до срока "deadline" (по возможности)
+SolveResult Solver::solve(std::chrono::steady_clock::time_point deadline)
+{
+    SolveResult result;
+    auto        start = std::chrono::steady_clock::now();
+    
     // Предварительная инициализация
-    wasSolved = false;
+    finish_    = deadline;
+    nSweeps_   = 0;
+    nRestarts_ = 0;
+    nNodes_    = 0;
+    saveBest(true);
+    isInterrupted_ = false;
     
-    // Строим пути
-    for (int32_t i = 0; i < MAIN_REPLAY_NUMBER && !wasSolved; ++i)
+    // Решаем выбранным движком
+    switch (engine_)
+    {
+        case BACKTRACK :
+            solveBacktrack();
+            break;
+            
+        case EXACT_COVER :
+            solveExactCover();
+            break;
+            
+        case ANNEALING :
+            solveAnneal();
+            break;
+            
+        default :
+            solveRandom();
+            break;
+    }
+    
+    // Не решили - оставляем на поле лучшее найденное состояние
+    if (status_ != SOLVED)
+    {
+        saveBest(false);
+        restoreBest();
+    }
+    result.status      = status_;
+    result.nIterations = static_cast<int64_t>(nSweeps_) + nNodes_;
+    result.nMisPaths   = getMisPathNumber();
+    result.time        = std::chrono::duration<float>(
+                             std::chrono::steady_clock::now() - start).count();
+    stats_.solveTime += result.time;
+    stats_.nSweeps   += nSweeps_;
+    return result;
+}
+
+// (10) Разбивает поле на независимые части
+void Solver::splitField(std::vector<Field>& parts)
+{
+    std::vector<int16_t> parent;
+    std::vector<int16_t> owner;
+    std::vector<int16_t> partBySlot;
+    std::vector<int16_t> fromStart;
+    std::vector<int16_t> fromEnd;
+    std::vector<int32_t> startCells;
+    std::vector<int32_t> endCells;
+    
+    // Нетривиальные клетки и их пары
+    if (!havePartners_)
+    {
+        createPartners();
+    }
+    
+    // Каждая клетка - пока отдельное множество
+    parent.resize(points_.size());
+    for (int16_t slot = 0; slot < points_.size(); ++slot)
+    {
+        parent[slot] = slot;
+    }
+    
+    // Объединяем клетки, пути пар которых могут пройти через одну клетку
+    // (клетка "c" пригодна, если |p - c| + |c - q| <= index - 1 по
+    // свободным пустым клеткам рабочей области)
+    owner.assign(map_.getPlaneLength(), -1);
+    fromStart.assign(map_.getPlaneLength(), -1);
+    fromEnd.assign(map_.getPlaneLength(), -1);
+    for (int16_t slot = 0; slot < points_.size(); ++slot)
+    {
+        int16_t limit = map_(points_[slot]).index - 1;
+        
+        for (int32_t k = partnerStart_[slot]; k < partnerStart_[slot + 1]; ++k)
+        {
+            spreadDistances(points_[slot], limit, partnerRegions_[k],
+                            fromStart, startCells);
+            spreadDistances(partners_[k], limit, partnerRegions_[k],
+                            fromEnd, endCells);
+            
+            for (int32_t i = 0; i < startCells.size(); ++i)
+            {
+                int32_t pos = startCells[i];
+                
+                if (fromEnd[pos] >= 0 && fromStart[pos] + fromEnd[pos] <= limit)
+                {
+                    if (owner[pos] < 0)
+                    {
+                        owner[pos] = slot;
+                    }
+                    else
+                    {
+                        parent[findRoot(parent, owner[pos])] =
+                            findRoot(parent, slot);
+                    }
+                }
+            }
+            
+            // Пара - в той же части
+            parent[findRoot(parent, slotById_[map_(partners_[k]).protoId])] =
+                findRoot(parent, slot);
+            
+            // Стираем расстояния (только задетые клетки)
+            for (int32_t i = 0; i < startCells.size(); ++i)
+            {
+                fromStart[startCells[i]] = -1;
+            }
+            for (int32_t i = 0; i < endCells.size(); ++i)
+            {
+                fromEnd[endCells[i]] = -1;
+            }
+        }
+    }
+    
+    // Номер части каждой клетки
+    parts.clear();
+    partBySlot.assign(points_.size(), -1);
+    for (int16_t slot = 0; slot < points_.size(); ++slot)
+    {
+        int16_t root = findRoot(parent, slot);
+        
+        if (partBySlot[root] < 0)
+        {
+            partBySlot[root] = parts.size();
+            parts.push_back(map_);
+            parts.back().refresh();
+        }
+        partBySlot[slot] = partBySlot[root];
+    }
+    
+    // В каждой части клетки других частей становятся единицами
+    for (int16_t slot = 0; slot < points_.size(); ++slot)
+    {
+        int32_t pos = map_.getPos(points_[slot]);
+        
+        for (int16_t part = 0; part < parts.size(); ++part)
+        {
+            if (part != partBySlot[slot])
+            {
+                parts[part].indexAt(pos) = 1;
+            }
+        }
+    }
+}
+
+// (11) Находит повторяющиеся самодостаточные блоки поля
+void Solver::findBlocks(std::vector<Field>& blocks,
+                        std::vector<std::vector<Vector>>& copies)
+{
+    const int16_t sizeX  = map_.getSizeX();
+    const int16_t sizeY  = map_.getSizeY();
+    const int32_t stride = sizeX + 1;
+    
+    std::vector<std::pair<int32_t, int32_t>> sizes;
+    std::vector<Field>                       curBlocks;
+    std::vector<std::vector<Vector>>         curCopies;
+    uint64_t inverseX = BLOCK_HASH_X;
+    uint64_t inverseY = BLOCK_HASH_Y;
+    uint64_t powerY   = 1;
+    uint64_t scaleY   = 1;
+    int32_t  best     = 0;
+    
+    blocks.clear();
+    copies.clear();
+    
+    // Рабочие области пар нужны для проверки блоков
+    if (!havePartners_)
+    {
+        createPartners();
+    }
+    
+    // Обратные множители по модулю 2^64 (метод Ньютона)
+    for (int16_t i = 0; i < 5; ++i)
+    {
+        inverseX *= 2 - BLOCK_HASH_X * inverseX;
+        inverseY *= 2 - BLOCK_HASH_Y * inverseY;
+    }
+    
+    // Префиксные суммы : хэш значений (клетка (x, y) с весом
+    // HASH_X^x * HASH_Y^y) и кол-во нетривиальных клеток. Сдвиг блока в
+    // начало координат - умножение на обратные веса его угла
+    blockHash_.assign(stride * (sizeY + 1), 0);
+    blockCount_.assign(stride * (sizeY + 1), 0);
+    blockScale_.resize(sizeX * sizeY);
+    for (int16_t y = 0; y < sizeY; ++y)
+    {
+        uint64_t power = powerY;
+        uint64_t scale = scaleY;
+        
+        for (int16_t x = 0; x < sizeX; ++x)
+        {
+            int16_t index = map_(x, y).index;
+            int32_t cur   = (y + 1) * stride + x + 1;
+            
+            blockHash_[cur]  = index * power + blockHash_[cur - 1] +
+                               blockHash_[cur - stride] -
+                               blockHash_[cur - stride - 1];
+            blockCount_[cur] = (index > 2) + blockCount_[cur - 1] +
+                               blockCount_[cur - stride] -
+                               blockCount_[cur - stride - 1];
+            blockScale_[y * sizeX + x] = scale;
+            power *= BLOCK_HASH_X;
+            scale *= inverseX;
+        }
+        powerY *= BLOCK_HASH_Y;
+        scaleY *= inverseY;
+    }
+    
+    // Оценки выигрыша размеров без проверки блоков
+    for (int16_t h = BLOCK_MIN_SIZE; h <= min(BLOCK_MAX_SIZE, sizeY); ++h)
+    {
+        for (int16_t w = BLOCK_MIN_SIZE; w <= min(BLOCK_MAX_SIZE, sizeX); ++w)
+        {
+            int32_t gain = chooseBlocks(w, h, false, curBlocks, curCopies);
+            
+            if (gain > 0)
+            {
+                sizes.push_back(std::make_pair(-gain, h * stride + w));
+            }
+        }
+    }
+    std::sort(sizes.begin(), sizes.end());
+    
+    // Точный выигрыш - по убыванию оценок, пока оценка больше лучшего
+    // (не больше BLOCK_CHECK_NUMBER размеров)
+    for (int32_t i = 0; i < min(sizes.size(), BLOCK_CHECK_NUMBER) &&
+                        -sizes[i].first > best; ++i)
+    {
+        int16_t w    = sizes[i].second % stride;
+        int16_t h    = sizes[i].second / stride;
+        int32_t gain = 0;
+        
+        // Пути блоков не должны занимать клетки, нужные другим парам
+        chooseBlocks(w, h, true, curBlocks, curCopies);
+        gain = lockBlocks(curBlocks, curCopies);
+        if (gain > best)
+        {
+            best = gain;
+            blocks.swap(curBlocks);
+            copies.swap(curCopies);
+        }
+    }
+    
+    // Префиксные суммы больше не нужны
+    blockHash_.clear();
+    blockScale_.clear();
+    blockCount_.clear();
+}
+
+// (12) Задает направления обхода путей (для вывода на экран)
+void Solver::setDirections()
+{
+    auto start = std::chrono::steady_clock::now();
+    
+    // Проходим по хранилищу путей, каждый путь - один раз
+    for (int16_t slot = 0; slot < points_.size(); ++slot)
+    {
+        const Vector* path   = pathCells_.data() + pathStart_[slot];
+        int16_t       length = pathLength_[slot];
+        bool          isFull = (length == map_(points_[slot]).index);
+        
+        for (int16_t k = 0; k < length; ++k)
+        {
+            if (isFull && k > 0 && k < length - 1)
+            {
+                setDirection(path[k - 1], path[k], path[k + 1]);
+            }
+            else
+            {
+                map_.setWayAt(map_.getPos(path[k]), NONE);
+            }
+        }
+    }
+    stats_.directionTime += std::chrono::duration<float>(
+                                std::chrono::steady_clock::now() -
+                                start).count();
+}
+
+// (13) Освобождает выделенную память
+void Solver::clear()
+{
+    map_.clear();
+    partnerStart_.clear();
+    partners_.clear();
+    partnerRegions_.clear();
+    candidates_.clear();
+    track_.clear();
+    points_.clear();
+    order_.clear();
+    slotById_.clear();
+    pathCells_.clear();
+    pathStart_.clear();
+    pathLength_.clear();
+    idArray_.clear();
+    stamp_.clear();
+    depth_.clear();
+    queue_.clear();
+    rowCells_.clear();
+    rowStart_.clear();
+    rowSlot_.clear();
+    rowColumns_.clear();
+    columnByPos_.clear();
+    cover_.clear();
+    distCells_.clear();
+    distStart_.clear();
+    distVersion_.clear();
+    tileByPos_.clear();
+    tileStamp_.clear();
+    idConflict_.clear();
+    cellConflict_.clear();
+    ripWeights_.clear();
+    tabu_.clear();
+    orderKey_.clear();
+    orderScore_.clear();
+    logSlot_.clear();
+    logStart_.clear();
+    logCells_.clear();
+    zobristCell_.clear();
+    zobristId_.clear();
+    table_.clear();
+    bestMap_.clear();
+    bestCells_.clear();
+    bestLength_.clear();
+    nAreas_     = 0;
+    nId_        = 0;
+    nSweeps_    = 0;
+    nRestarts_  = 0;
+    nMisPoints_ = 0;
+    nCovered_   = 0;
+    hash_       = 0;
+    nStamp_     = 0;
+    nNodes_     = 0;
+    status_     = TIMEOUT;
+    
+    havePartners_ = false;
+}
+
+// (14) Задает зерно генератора случайных чисел
+void Solver::setSeed(uint64_t seed)
+{
+    random_.setSeed(seed);
+}
+
+// (15) Задает внешний флаг остановки (nullptr - нет флага)
+void Solver::setStopFlag(const std::atomic<bool>* stop)
+{
+    stop_ = stop;
+}
+
+// (16) Задает обработчик хода решения (пустой - без индикации)
+void Solver::setProgress(const std::function<void(int32_t, int16_t)>&
+                         progress)
+{
+    progress_ = progress;
+}
+
+// (17) Выбирает движок решения
+void Solver::setEngine(Engine engine)
+{
+    engine_ = engine;
+}
+
+// (18) Задает лимит времени перебора (мс)
+void Solver::setTimeLimit(int32_t timeLimit)
+{
+    timeLimit_ = (timeLimit > 0) ? timeLimit : 0;
+}
+
+// (19) Возвращает итог последнего "solve"
+SolveStatus Solver::getStatus() const
+{
+    return status_;
+}
+
+// (20) Задает политику перезапусков
+void Solver::setRestart(RestartPolicy policy, RestartAction action,
+                        int32_t base)
+{
+    restartPolicy_ = policy;
+    restartAction_ = action;
+    restartBase_   = (base > 0) ? base : 1;
+}
+
+// (21) Задает порядок обхода нетривиальных клеток
+void Solver::setOrder(OrderPolicy policy)
+{
+    orderPolicy_ = policy;
+}
+
+// (22) Возвращает кол-во проходов последнего "solve"
+int32_t Solver::getSweepNumber() const
+{
+    return nSweeps_;
+}
+
+// (23) Возвращает кол-во перезапусков последнего "solve"
+int32_t Solver::getRestartNumber() const
+{
+    return nRestarts_;
+}
+
+// (24) Задает память таблицы перестановок (0 - без таблицы)
+void Solver::setTableMemory(size_t memory)
+{
+    tableMemory_ = memory;
+}
+
+// (25) Возвращает кол-во попаданий в таблицу перестановок
+int64_t Solver::getTableHitNumber() const
+{
+    return table_.getHitNumber();
+}
+
+// (26) Возвращает кол-во промахов таблицы перестановок
+int64_t Solver::getTableMissNumber() const
+{
+    return table_.getMissNumber();
+}
+
+// (27) Включает или выключает сбор статистики
+void Solver::setStats(bool isEnabled)
+{
+    isStatsOn_ = isEnabled;
+}
+
+// (28) Возвращает статистику решения
+const SolverStats& Solver::getStats() const
+{
+    return stats_;
+}
+
+////////// private ///////////////////////////////////////////////////////////
+
+// (1) Составляет область поиска соседей
+void Solver::createCheckingArea(Vector point, Region& region)
+{
+    // Пара лежит не дальше "index - 1" шагов от клетки
+    createRegion(point, point, 2 * (map_(point).index - 1), region);
+}
+
+// (2) Составляет рабочую область для двух точек
+void Solver::createWorkingArea(Vector p1, Vector p2, Region& region)
+{
+    // Путь из "index" клеток проходит только через клетки "c", у которых
+    // |p1 - c| + |c - p2| <= index - 1
+    createRegion(p1, p2, map_(p1).index - 1, region);
+}
+
+// (3) Составляет область клеток "c" : |p1 - c| + |c - p2| <= budget
+void Solver::createRegion(Vector p1, Vector p2, int16_t budget,
+                          Region& region)
+{
+    // Величина расширения прямоугольника, натянутого на точки
+    int16_t shift = (budget - distance(p1, p2) + 1) / 2;
+    Area&   box   = region.box;
+    
+    // Продлеваем границы на величину "shift"
+    box.maxX = min(map_.getSizeX() - 1, max(p1.x + shift, p2.x + shift));
+    box.minX = max(0, min(p1.x - shift, p2.x - shift));
+    box.maxY = min(map_.getSizeY() - 1, max(p1.y + shift, p2.y + shift));
+    box.minY = max(0, min(p1.y - shift, p2.y - shift));
+    
+    region.minX.resize(box.maxY - box.minY + 1);
+    region.maxX.resize(box.maxY - box.minY + 1);
+    
+    // В строке "y" остается запас на |x - p1.x| + |x - p2.x|
+    for (int16_t y = box.minY; y <= box.maxY; ++y)
+    {
+        int16_t rest  = budget - abs(y - p1.y) - abs(y - p2.y);
+        int16_t left  = min(p1.x, p2.x);
+        int16_t right = max(p1.x, p2.x);
+        int16_t row   = y - box.minY;
+        
+        if (rest >= right - left)
+        {
+            int16_t ext = (rest - (right - left)) / 2;
+            
+            region.minX[row] = max(box.minX, left - ext);
+            region.maxX[row] = min(box.maxX, right + ext);
+        }
+        else
+        {
+            // Пустая строка
+            region.minX[row] = box.maxX + 1;
+            region.maxX[row] = box.maxX;
+        }
+    }
+}
+
+// (4) Точки являются соседями?
+bool Solver::areRelatedPoints(Vector p1, Vector p2)
+{
+    // Совпадение индексов
+    if (map_(p1).index == map_(p2).index)
     {
-        if (i % 3 == 0)
+        // Точки разные
+        if (p1 != p2)
+        {
+            // Расстояние между точками
+            int16_t differ = map_(p1).index - distance(p1, p2);
+            
+            // Условие сущ-я пути между точками
+            if (differ >= 0 && differ % 2 == 0)
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// (5) Находит нетривиальные клетки и списки их пар
+void Solver::createPartners()
+{
+    Vector iPoint;
+    Vector jPoint;
+    Region area;
+    Region workArea;
+    
+    try
+    {
+        points_.clear();
+        partners_.clear();
+        partnerRegions_.clear();
+        partnerStart_.assign(1, 0);
+        
+        // Соответствие "protoId" -> номер нетривиальной клетки
+        slotById_.assign(map_.getSizeX() * map_.getSizeY() + 1, -1);
+        
+        // Записываем клетки с цифрами > 2 (в порядке обхода поля)
+        for (iPoint.y = 0; iPoint.y < map_.getSizeY(); ++iPoint.y)
+        {
+            for (iPoint.x = 0; iPoint.x < map_.getSizeX(); ++iPoint.x)
+            {
+                if (map_(iPoint).index > 2)
+                {
+                    slotById_[map_(iPoint).protoId] = points_.size();
+                    points_.push_back(iPoint);
+                }
+            }
+        }
+        
+        // Для каждой клетки один раз просматриваем ее область поиска
+        for (int16_t i = 0; i < points_.size(); ++i)
+        {
+            createCheckingArea(points_[i], area);
+            for (jPoint.y = area.box.minY; jPoint.y <= area.box.maxY;
+                 ++jPoint.y)
+            {
+                int16_t row = jPoint.y - area.box.minY;
+                
+                for (jPoint.x = area.minX[row]; jPoint.x <= area.maxX[row];
+                     ++jPoint.x)
+                {
+                    if (areRelatedPoints(points_[i], jPoint))
+                    {
+                        createWorkingArea(points_[i], jPoint, workArea);
+                        partners_.push_back(jPoint);
+                        partnerRegions_.push_back(workArea);
+                    }
+                }
+            }
+            partnerStart_.push_back(partners_.size());
+        }
+    }
+    catch (...)
+    {
+        clear();
+        throw;
+    }
+    havePartners_ = true;
+}
+
+// (6) Корень множества клетки номер "slot" (со сжатием путей)
+int16_t Solver::findRoot(std::vector<int16_t>& parent, int16_t slot)
+{
+    int16_t root = slot;
+    
+    while (parent[root] != root)
+    {
+        root = parent[root];
+    }
+    while (parent[slot] != root)
+    {
+        int16_t next = parent[slot];
+        
+        parent[slot] = root;
+        slot         = next;
+    }
+    return root;
+}
+
+// (7) Расстояния от клетки "from" по свободным пустым клеткам области
+void Solver::spreadDistances(Vector from, int16_t limit, const Region& region,
+                             std::vector<int16_t>& dist,
+                             std::vector<int32_t>& cells)
+{
+    int32_t head   = 0;
+    int32_t stride = map_.getPos(0, 1) - map_.getPos(0, 0);
+    
+    // Обход в ширину (список клеток служит очередью)
+    cells.clear();
+    cells.push_back(map_.getPos(from));
+    dist[cells[0]] = 0;
+    while (head < cells.size())
+    {
+        int32_t pos = cells[head++];
+        Vector  cur(pos % stride - 1, pos / stride - 1);
+        
+        for (int16_t dir = 0; dir < 4 && dist[pos] < limit; ++dir)
+        {
+            Vector  near(cur.x + SHIFT_X[dir], cur.y + SHIFT_Y[dir]);
+            int32_t nearPos = pos + map_.getShift(dir);
+            
+            if (region.inRange(near) && dist[nearPos] < 0 &&
+                map_.indexAt(nearPos) == 0)
+            {
+                dist[nearPos] = dist[pos] + 1;
+                cells.push_back(nearPos);
+            }
+        }
+    }
+}
+
+// (8) Выбирает блоки "sizeX x sizeY" (возвращает выигрыш)
+int32_t Solver::chooseBlocks(int16_t sizeX, int16_t sizeY, bool isChecked,
+                             std::vector<Field>& blocks,
+                             std::vector<std::vector<Vector>>& copies)
+{
+    const int16_t fieldX  = map_.getSizeX();
+    const int16_t fieldY  = map_.getSizeY();
+    const int32_t stride  = fieldX + 1;
+    const int16_t nBoxesX = fieldX / sizeX + 1;
+    
+    std::vector<std::pair<uint64_t, int32_t>> windows;
+    std::vector<int32_t> groupOf;
+    std::vector<int32_t> groupSize;
+    std::vector<int32_t> groupFirst;
+    std::vector<int32_t> groupState;
+    std::vector<int32_t> box;
+    std::vector<Vector>  chosen;
+    int32_t gain = 0;
+    
+    blocks.clear();
+    copies.clear();
+    
+    // Хэш каждого окна (x, y) с хотя бы одной нетривиальной клеткой
+    for (int16_t y = 0; y + sizeY <= fieldY; ++y)
+    {
+        for (int16_t x = 0; x + sizeX <= fieldX; ++x)
+        {
+            int32_t  p1    = y * stride + x;
+            int32_t  p2    = (y + sizeY) * stride + x;
+            int32_t  count = blockCount_[p2 + sizeX] - blockCount_[p2] -
+                             blockCount_[p1 + sizeX] + blockCount_[p1];
+            uint64_t hash  = blockHash_[p2 + sizeX] - blockHash_[p2] -
+                             blockHash_[p1 + sizeX] + blockHash_[p1];
+            
+            if (count > 0)
+            {
+                windows.push_back(std::make_pair(hash *
+                                  blockScale_[y * fieldX + x],
+                                  y * fieldX + x));
+            }
+        }
+    }
+    
+    // Окна с равными хэшами - группа (кандидаты в копии одного блока)
+    std::sort(windows.begin(), windows.end());
+    groupOf.assign(fieldX * fieldY, -1);
+    for (int32_t i = 0; i < windows.size(); ++i)
+    {
+        if (i == 0 || windows[i].first != windows[i - 1].first)
+        {
+            groupSize.push_back(0);
+        }
+        groupOf[windows[i].second] = groupSize.size() - 1;
+        ++groupSize.back();
+    }
+    groupFirst.assign(groupSize.size(), -1);
+    groupState.assign(groupSize.size(), -1);
+    
+    // Жадно берем непересекающиеся окна по строкам. В ячейке сетки
+    // "sizeX x sizeY" лежит не больше одного угла взятого окна, поэтому
+    // пересечение проверяется по 3 x 3 соседним ячейкам
+    box.assign(nBoxesX * (fieldY / sizeY + 1), -1);
+    for (int16_t y = 0; y + sizeY <= fieldY; ++y)
+    {
+        for (int16_t x = 0; x + sizeX <= fieldX; ++x)
+        {
+            int32_t group  = groupOf[y * fieldX + x];
+            bool    isFree = true;
+            
+            if (group < 0 || groupSize[group] < 2)
+            {
+                continue;
+            }
+            for (int16_t by = max(0, y / sizeY - 1);
+                 by <= y / sizeY + 1 && by <= fieldY / sizeY && isFree; ++by)
+            {
+                for (int16_t bx = max(0, x / sizeX - 1);
+                     bx <= x / sizeX + 1 && bx < nBoxesX && isFree; ++bx)
+                {
+                    int32_t other = box[by * nBoxesX + bx];
+                    
+                    if (other >= 0 &&
+                        abs(other % fieldX - x) < sizeX &&
+                        abs(other / fieldX - y) < sizeY)
+                    {
+                        isFree = false;
+                    }
+                }
+            }
+            if (!isFree)
+            {
+                continue;
+            }
+            
+            if (isChecked)
+            {
+                // Первое окно группы - образец блока : рабочие области
+                // всех пар его клеток лежат внутри него, и отдельно (со
+                // стенами вокруг) он задан корректно
+                if (groupState[group] < 0 &&
+                    !isInsideBlock(x, y, sizeX, sizeY))
+                {
+                    groupState[group] = 0;
+                }
+                if (groupState[group] < 0)
+                {
+                    Field  block;
+                    Solver probe;
+                    
+                    block.resize(sizeX, sizeY);
+                    for (int16_t j = 0; j < sizeY; ++j)
+                    {
+                        for (int16_t i = 0; i < sizeX; ++i)
+                        {
+                            block(i, j).index = map_(x + i, y + j).index;
+                        }
+                    }
+                    probe.setField(block);
+                    groupState[group] = probe.isCorrectField() ? 1 : 0;
+                    if (groupState[group] == 1)
+                    {
+                        blocks.push_back(block);
+                        copies.push_back(std::vector<Vector>());
+                        groupState[group] = blocks.size();
+                    }
+                }
+                if (groupState[group] == 0)
+                {
+                    continue;
+                }
+                
+                // Совпадение хэшей проверяем по клеткам
+                const Field& block = blocks[groupState[group] - 1];
+                
+                for (int16_t j = 0; j < sizeY && isFree; ++j)
+                {
+                    for (int16_t i = 0; i < sizeX && isFree; ++i)
+                    {
+                        isFree = block(i, j).index ==
+                                 map_(x + i, y + j).index;
+                    }
+                }
+                if (!isFree)
+                {
+                    continue;
+                }
+                copies[groupState[group] - 1].push_back(Vector(x, y));
+            }
+            
+            box[(y / sizeY) * nBoxesX + x / sizeX] = y * fieldX + x;
+            chosen.push_back(Vector(x, y));
+            if (groupFirst[group] < 0)
+            {
+                groupFirst[group] = y * fieldX + x;
+            }
+        }
+    }
+    
+    // Выигрыш - нетривиальные клетки всех копий, кроме первой
+    groupSize.assign(groupSize.size(), 0);
+    for (int32_t i = 0; i < chosen.size(); ++i)
+    {
+        ++groupSize[groupOf[chosen[i].y * fieldX + chosen[i].x]];
+    }
+    for (int32_t i = 0; i < chosen.size(); ++i)
+    {
+        int32_t cell  = chosen[i].y * fieldX + chosen[i].x;
+        int32_t group = groupOf[cell];
+        int32_t p1    = chosen[i].y * stride + chosen[i].x;
+        int32_t p2    = (chosen[i].y + sizeY) * stride + chosen[i].x;
+        
+        if (groupSize[group] > 1 && groupFirst[group] != cell)
+        {
+            gain += blockCount_[p2 + sizeX] - blockCount_[p2] -
+                    blockCount_[p1 + sizeX] + blockCount_[p1];
+        }
+    }
+    
+    // Блоки с одной копией ничего не дают
+    for (int32_t k = blocks.size() - 1; k >= 0; --k)
+    {
+        if (copies[k].size() < 2)
+        {
+            blocks.erase(blocks.begin() + k);
+            copies.erase(copies.begin() + k);
+        }
+    }
+    return gain;
+}
+
+// (9) Рабочие области пар клеток блока лежат внутри него?
+bool Solver::isInsideBlock(int16_t x, int16_t y, int16_t sizeX, int16_t sizeY)
+{
+    for (int16_t j = y; j < y + sizeY; ++j)
+    {
+        for (int16_t i = x; i < x + sizeX; ++i)
+        {
+            if (map_(i, j).index <= 2)
+            {
+                continue;
+            }
+            
+            int16_t slot = slotById_[map_(i, j).protoId];
+            
+            for (int32_t k = partnerStart_[slot]; k < partnerStart_[slot + 1];
+                 ++k)
+            {
+                const Area& area = partnerRegions_[k].box;
+                
+                if (area.minX < x || area.maxX >= x + sizeX ||
+                    area.minY < y || area.maxY >= y + sizeY)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// (10) Закрывает клетки блоков, нужные парам вне копий (выигрыш)
+int32_t Solver::lockBlocks(std::vector<Field>& blocks,
+                           std::vector<std::vector<Vector>>& copies)
+{
+    const int16_t sizeX = map_.getSizeX();
+    
+    std::vector<int32_t> used;
+    std::vector<int32_t> own;
+    int32_t              gain = 0;
+    
+    // Сколько рабочих областей пар накрывают каждую клетку
+    used.assign(sizeX * map_.getSizeY(), 0);
+    for (int32_t k = 0; k < partners_.size(); ++k)
+    {
+        const Region& region = partnerRegions_[k];
+        
+        for (int16_t y = region.box.minY; y <= region.box.maxY; ++y)
+        {
+            int16_t row = y - region.box.minY;
+            
+            for (int16_t x = region.minX[row]; x <= region.maxX[row]; ++x)
+            {
+                ++used[y * sizeX + x];
+            }
+        }
+    }
+    
+    // Клетка копии нужна чужой паре, если ее накрывают не только
+    // области пар самой копии (они целиком внутри копии)
+    for (int16_t b = 0; b < blocks.size(); ++b)
+    {
+        const int16_t blockX = blocks[b].getSizeX();
+        const int16_t blockY = blocks[b].getSizeY();
+        
+        for (int32_t c = 0; c < copies[b].size(); ++c)
+        {
+            const Vector corner = copies[b][c];
+            
+            own.assign(blockX * blockY, 0);
+            for (int16_t j = 0; j < blockY; ++j)
+            {
+                for (int16_t i = 0; i < blockX; ++i)
+                {
+                    if (map_(corner.x + i, corner.y + j).index <= 2)
+                    {
+                        continue;
+                    }
+                    
+                    int16_t slot =
+                        slotById_[map_(corner.x + i, corner.y + j).protoId];
+                    
+                    for (int32_t k = partnerStart_[slot];
+                         k < partnerStart_[slot + 1]; ++k)
+                    {
+                        const Region& region = partnerRegions_[k];
+                        
+                        for (int16_t y = region.box.minY;
+                             y <= region.box.maxY; ++y)
+                        {
+                            int16_t row = y - region.box.minY;
+                            
+                            for (int16_t x = region.minX[row];
+                                 x <= region.maxX[row]; ++x)
+                            {
+                                ++own[(y - corner.y) * blockX + x - corner.x];
+                            }
+                        }
+                    }
+                }
+            }
+            
+            // Такие пустые клетки закрываются во всех копиях блока
+            for (int16_t j = 0; j < blockY; ++j)
+            {
+                for (int16_t i = 0; i < blockX; ++i)
+                {
+                    int32_t cell = (corner.y + j) * sizeX + corner.x + i;
+                    
+                    if (blocks[b](i, j).index == 0 &&
+                        used[cell] > own[j * blockX + i])
+                    {
+                        blocks[b](i, j).index = 1;
+                    }
+                }
+            }
+        }
+    }
+    
+    // Блоки, клетки которых лишились путей к парам, убираем
+    for (int16_t b = blocks.size() - 1; b >= 0; --b)
+    {
+        Solver probe;
+        bool   isLive = false;
+        
+        probe.setField(blocks[b]);
+        if (probe.isCorrectField())
+        {
+            probe.prepare();
+            isLive = true;
+            for (int16_t slot = 0; slot < probe.points_.size() && isLive;
+                 ++slot)
+            {
+                isLive = probe.countLivePartners(slot) > 0;
+            }
+        }
+        if (isLive)
+        {
+            gain += (copies[b].size() - 1) * probe.points_.size();
+        }
+        else
+        {
+            blocks.erase(blocks.begin() + b);
+            copies.erase(copies.begin() + b);
+        }
+    }
+    return gain;
+}
+
+// (11) Разводит пути случайным блужданием
+void Solver::solveRandom()
+{
+    int32_t nBest     = getMisPathNumber();
+    int32_t nStalls   = 0;
+    bool    wasSolved = (nBest == 0);
+    
+    // Составляем порядок обхода нетрив. точек
+    createOrder();
+    
+    // Строим пути (пока нас не остановили извне)
+    for (int32_t i = 0; i < MAIN_REPLAY_NUMBER && !wasSolved; ++i)
+    {
+        if (isInterrupted_ || isCancelled())
+        {
+            break;
+        }
+        
+        // Проходим по всем нетривиальным точкам
+        createAllPaths();
+        ++nSweeps_;
+        
+        // Проверям кол-во незадействованных нетрив. клеток
+        int32_t nMisPaths = getMisPathNumber();
+        
+        wasSolved = (nMisPaths == 0);
+        saveBest(false);
+        
+        // Лучший результат давно не улучшался - перезапускаемся
+        if (nMisPaths < nBest)
+        {
+            nBest   = nMisPaths;
+            nStalls = 0;
+        }
+        else if (++nStalls >= getRestartLimit() && !wasSolved)
+        {
+            restart();
+            nBest   = getMisPathNumber();
+            nStalls = 0;
+            if (isStatsOn_)
+            {
+                ++stats_.nRestarts;
+            }
+        }
+        
+        // Сообщаем о ходе решения
+        if (i % INDICATOR_NUMBER == 0 && progress_)
+        {
+            progress_(nSweeps_, nMisPaths);
+        }
+    }
+    
+    // Случайное блуждание не может доказать отсутствие решения
+    status_ = wasSolved ? SOLVED : TIMEOUT;
+}
+
+// (12) Допустимое кол-во проходов без улучшения до перезапуска
+int32_t Solver::getRestartLimit() const
+{
+    int32_t limit = restartBase_;
+    
+    switch (restartPolicy_)
+    {
+        case RESTART_GEOMETRIC :
+        {
+            // base * growth^k (с ограничением сверху)
+            double value = restartBase_;
+            
+            for (int32_t k = 0; k < nRestarts_ && value < MAIN_REPLAY_NUMBER;
+                 ++k)
+            {
+                value *= RESTART_GROWTH;
+            }
+            limit = (value < MAIN_REPLAY_NUMBER) ? int32_t(value) :
+                                                   MAIN_REPLAY_NUMBER;
+            break;
+        }
+        
+        case RESTART_LUBY :
+        {
+            // Член номер "nRestarts_" последовательности 1 1 2 1 1 2 4 ...
+            int32_t k    = nRestarts_;
+            int32_t size = 1;
+            int16_t seq  = 0;
+            
+            while (size < k + 1)
+            {
+                size = 2 * size + 1;
+                ++seq;
+            }
+            while (size - 1 != k)
+            {
+                size = (size - 1) >> 1;
+                k    = k % size;
+                --seq;
+            }
+            limit = restartBase_ << pcs::min(seq, 16);
+            break;
+        }
+        
+        default :
+            break;
+    }
+    return limit;
+}
+
+// (13) Перезапускает блуждание
+void Solver::restart()
+{
+    // Очищаем поле до состояния после "prepare" (штрафы сохраняются)
+    if (restartAction_ == RESET)
+    {
+        for (int16_t slot = 0; slot < points_.size(); ++slot)
+        {
+            if (pathLength_[slot] > 0)
+            {
+                deletePath(points_[slot]);
+            }
+        }
+    }
+    
+    // Новый порядок обхода нетрив. точек
+    createOrder();
+    ++nRestarts_;
+}
+
+// (14) Составляет порядок обхода нетривиальных клеток
+void Solver::createOrder()
+{
+    // Случайная перестановка (для стесненного порядка - разбивает равенства)
+    createPermutation(order_, random_);
+    if (orderPolicy_ == ORDER_RANDOM)
+    {
+        return;
+    }
+    
+    // Ключ клетки : постоянная стесненность, занятые соседи, шум
+    for (int16_t slot = 0; slot < points_.size(); ++slot)
+    {
+        int32_t pos   = map_.getPos(points_[slot]);
+        int16_t nNear = 0;
+        
+        for (int16_t dir = 0; dir < 4; ++dir)
+        {
+            nNear += (map_.idAt(pos + map_.getShift(dir)) != 0);
+        }
+        orderScore_[slot] = orderKey_[slot] - ORDER_NEAR_WEIGHT * nNear +
+                            ORDER_NOISE * random_.uniformReal();
+    }
+    
+    // Самые стесненные клетки - первыми
+    std::stable_sort(order_.begin(), order_.end(),
+                     [this](int16_t a, int16_t b)
+                     {
+                         return orderScore_[a] < orderScore_[b];
+                     });
+}
+
+// (15) Вычисляет постоянную часть стесненности клеток
+void Solver::createOrderKeys()
+{
+    orderKey_.resize(points_.size());
+    for (int16_t slot = 0; slot < points_.size(); ++slot)
+    {
+        Vector  point = points_[slot];
+        int16_t index = map_(point).index;
+        int16_t slack = index;
+        
+        // Наименьший запас длины пути по всем парам
+        for (int32_t k = partnerStart_[slot]; k < partnerStart_[slot + 1]; ++k)
+        {
+            slack = pcs::min(slack, index - distance(point, partners_[k]));
+        }
+        orderKey_[slot] = ORDER_PARTNER_WEIGHT *
+                          (partnerStart_[slot + 1] - partnerStart_[slot]) +
+                          ORDER_SLACK_WEIGHT * slack -
+                          ORDER_INDEX_WEIGHT * index;
+    }
+}
+
+// (16) Строит (по возможности) все пути
+void Solver::createAllPaths()
+{
+    // Проходим по нетривиальным точкам и строим пути (пока есть пустые)
+    for (int16_t i = 0; i < order_.size() && nMisPoints_ > 0 &&
+                        !isInterrupted_; ++i)
+    {
+        createPath(points_[order_[i]], true);
+    }
+}
+
+// (17) Строит путь из точки "point" (canRip - удалять помехи)
+void Solver::createPath(Vector point, bool canRip)
+{
+    bool wasCreated = false;
+    bool wasDeleted = true;
+    
+    if (isStatsOn_)
+    {
+        ++stats_.nPathCalls;
+    }
+    
+    // Имеет ли смысл строить путь?
+    if (map_(point).id == 0 && map_(point).index != 0)
+    {
+        int16_t slot = slotById_[map_(point).protoId];
+        
+        // Берем готовый список пар, начинаем отсчет "id" заново
+        candidates_.clear();
+        for (int32_t k = partnerStart_[slot]; k < partnerStart_[slot + 1]; ++k)
+        {
+            candidates_.push_back(k);
+        }
+        nAreas_ = candidates_.size();
+        nId_    = 0;
+        
+        // Переставляем случайным образом рабочие области
+        createPermutation(candidates_, nAreas_, random_);
+        
+        // Пытаемся провести путь из точки "point"
+        while (!wasCreated && wasDeleted && !isInterrupted_)
+        {
+            // Перебираем соседей поочередно
+            for (int16_t i = 0; i < nAreas_ && !wasCreated &&
+                                !isInterrupted_; ++i)
+            {
+                createAreaPath(point, candidates_[i], wasCreated);
+            }
+            
+            // Если не удалось построить, то удаляем случайный путь "id"
+            if (!wasCreated && canRip)
+            {
+                deleteRandomPath(wasDeleted);
+            }
+            else
+            {
+                wasDeleted = false;
+            }
+        }
+    }
+}
+
+// (18) Создает новый путь из точки "point" в ее пару номер "pair"
+void Solver::createAreaPath(Vector point, int32_t pair, bool& wasCreated)
+{
+    // Парная клетка и рабочая область (и описанный прямоугольник)
+    const Vector  target = partners_[pair];
+    const Region& region = partnerRegions_[pair];
+    const Area&   area   = region.box;
+    
+    // Первичная инициализация
+    wasCreated = false;
+    
+    // Имеет ли смысл строить путь?
+    if (map_(point).id == 0 && map_(point).index != 0 && region.isCorrect())
+    {
+        bool    isFinished = false;     // Нашли путь или он не сущ-ет
+        bool    forward    = true;      // Направление последнего сдвига
+        bool    stepMatch  = false;     // Дошли до конца ветви пути
+        int16_t step       = 0;         // Текущий сдвиг от начала пути
+        int16_t dir        = 0;         // Код очередного сдвига
+        int32_t count      = 0;         // Счетчик циклов
+        
+        // Значение и "id" начальной клетки пути
+        const int16_t index   = map_(point).index;
+        const int16_t protoId = map_(point).protoId;
+        
+        // Блок хранилища путей: клетки пути по порядку и их кол-во
+        const int16_t slot   = slotById_[protoId];
+        Vector*       path   = pathCells_.data() + pathStart_[slot];
+        int16_t&      length = pathLength_[slot];
+        
+        // Текущая позиция (координаты и смещение в плоскостях поля)
+        Vector  curPoint;
+        int32_t curPos = 0;
+        
+        // Расстояния до пары по свободным клеткам (нижняя оценка шагов)
+        const uint8_t* dist  = getDistances(pair);
+        const int16_t  width = area.maxX - area.minX + 1;
+        
+        // Пара недостижима - блуждать бессмысленно, запоминаем помехи
+        if (dist[(point.y - area.minY) * width + point.x - area.minX] >
+            index - 1)
+        {
+            collectBlockers(point, pair);
+            return;
+        }
+        
+        // Свои шаги блуждания плиток не меняют (до итога)
+        isWalking_ = true;
+        for (int16_t i = 0; i < PATH_REPLAY_NUMBER && !isFinished &&
+                            !isInterrupted_; ++i)
+        {
+            // Обновляем счетчик, сдвиг, текущую позицию
+            count    = 0;
+            step     = 0;
+            curPoint = point;
+            curPos   = map_.getPos(point);
+            forward  = true;
+            
+            // Удаляем остатки пути
+            deletePath(point);
+            
+            // Случайным перебором находим подходящий путь
+            while (!isFinished && count < PATH_CYCLES_NUMBER &&
+                   !isInterrupted_)
+            {
+                // Проверяем, в какой точке поля оказались
+                if (!region.inRange(curPoint))
+                {
+                    // Вышли за границы области
+                    --step;
+                    forward  = false;
+                    curPoint = path[step];
+                    curPos   = map_.getPos(curPoint);
+                }
+                else
+                if (map_.idAt(curPos) == 0)
+                {
+                    stepMatch = (step == index - 1);
+                    
+                    // Анализ очередной свободной точки 
+                    if (curPoint == target && stepMatch)
+                    {
+                        occupyCell(curPos, protoId, step);
+                        path[step] = curPoint;
+                        length     = step + 1;
+                        isFinished = true;
+                        wasCreated = true;
+                    }
+                    else
+                    if (step == 0 || (map_.indexAt(curPos) == 0 &&
+                        dist[(curPoint.y - area.minY) * width + curPoint.x -
+                             area.minX] <= index - 1 - step))
+                    {
+                        // Пара еще достижима за оставшиеся шаги
+                        occupyCell(curPos, protoId, step);
+                        path[step] = curPoint;
+                        length     = step + 1;
+                        
+                        // Делаем случайный сдвиг
+                        track_[step].regenerate(random_);
+                        dir         = track_[step].getShiftCode();
+                        curPoint.x += SHIFT_X[dir];
+                        curPoint.y += SHIFT_Y[dir];
+                        curPos     += map_.getShift(dir);
+                        ++step;
+                        forward     = true;
+                    }
+                    else
+                    {
+                        --step;
+                        forward  = false;
+                        curPoint = path[step];
+                        curPos   = map_.getPos(curPoint);
+                    }
+                }
+                else
+                if (map_.idAt(curPos) == protoId && !forward)
+                {
+                    // Произошел обратный ход
+                    if (!track_[step].haveFinished())
+                    {
+                        dir         = track_[step].getShiftCode();
+                        curPoint.x += SHIFT_X[dir];
+                        curPoint.y += SHIFT_Y[dir];
+                        curPos     += map_.getShift(dir);
+                        ++step;
+                        forward     = true;
+                    }
+                    else
+                    {
+                        releaseCell(curPos);
+                        length = step;
+                        
+                        // Анализируем шаг, на котором оказались
+                        if (step > 0)
+                        {
+                            --step;
+                            forward  = false;
+                            curPoint = path[step];
+                            curPos   = map_.getPos(curPoint);
+                        }
+                        else
+                        {
+                            isFinished = true;
+                        }
+                    }
+                }
+                else
+                {
+                    checkAddId(index, protoId, curPos);
+                    --step;
+                    forward  = false;
+                    curPoint = path[step];
+                    curPos   = map_.getPos(curPoint);
+                }
+                
+                // Долгое блуждание может прервать флаг остановки или срок
+                if (++count % WALK_CHECK_NUMBER == 0 && isCancelled())
+                {
+                    isInterrupted_ = true;
+                }
+            }
+            
+            // Шаги блуждания и упоры в PATH_CYCLES_NUMBER
+            if (isStatsOn_)
+            {
+                stats_.nWalkSteps += count;
+                stats_.nCycleCaps += (count >= PATH_CYCLES_NUMBER);
+            }
+        }
+        
+        // Если не смогли построить, то удаляем остатки пути
+        if (!isFinished)
+        {
+            deletePath(point);
+        }
+        isWalking_ = false;
+        
+        // Новый путь меняет плитки, по которым прошел
+        if (wasCreated)
+        {
+            if (isStatsOn_)
+            {
+                ++stats_.nBuilt[index];
+            }
+            for (int16_t k = 0; k < length; ++k)
+            {
+                touchTile(map_.getPos(path[k]));
+            }
+        }
+    }
+}
+
+// (19) Удаляет путь из точки "point" (isUndo - откат журнала)
+void Solver::deletePath(Vector point, bool isUndo)
+{
+    int16_t slot = slotById_[map_(point).protoId];
+    
+    // Клетки пути берем из хранилища путей
+    if (slot >= 0)
+    {
+        const Vector* path = pathCells_.data() + pathStart_[slot];
+        
+        // Удаленным считается только достроенный путь (не откат отжига)
+        if (isStatsOn_ && !isUndo && pathLength_[slot] == map_(point).index)
+        {
+            ++stats_.nDeleted[map_(point).index];
+        }
+        for (int16_t k = 0; k < pathLength_[slot]; ++k)
+        {
+            releaseCell(map_.getPos(path[k]));
+        }
+        pathLength_[slot] = 0;
+    }
+}
+
+// (20) Удаляет путь с номером "id"
+void Solver::deletePath(int16_t id)
+{
+    if (id > 0)
+    {
+        deletePath(getPosition(id));
+    }
+}
+
+// (21) Удаляет мешающий путь (с учетом штрафов конфликтов)
+void Solver::deleteRandomPath(bool& wasDeleted)
+{
+    if (nId_ > 0)
+    {
+        int16_t delIdNum = nId_ - 1;
+        double  total    = 0;
+        
+        // Вес пути - его штраф на единицу длины (недавно удаленные - 0)
+        for (int16_t i = 0; i < nId_; ++i)
+        {
+            ripWeights_[i] = isTabu(idArray_[i]) ? 0 :
+                                                   getRipWeight(idArray_[i]);
+            total += ripWeights_[i];
+        }
+        
+        // Выбираем мешающий путь пропорционально весу (если все под
+        // запретом - равновероятно)
+        if (total > 0)
+        {
+            double level = random_.uniformReal() * total;
+            
+            for (int16_t i = 0; i < nId_; ++i)
+            {
+                level -= ripWeights_[i];
+                if (level < 0 && ripWeights_[i] > 0)
+                {
+                    delIdNum = i;
+                    break;
+                }
+            }
+        }
+        else
+        {
+            delIdNum = random_.uniform(nId_);
+        }
+        
+        // Удаляем мешающий путь на поле и запрещаем удалять его снова
+        deletePath(idArray_[delIdNum]);
+        if (isStatsOn_)
+        {
+            ++stats_.nRipUps;
+        }
+        tabu_[nTabu_] = idArray_[delIdNum];
+        nTabu_        = (nTabu_ + 1) % TABU_LENGTH;
+        
+        // Убрать "id" пути из массива мешающих "id" (на его место - последний)
+        idArray_[delIdNum] = idArray_[nId_ - 1];
+        --nId_;
+        
+        // Старые штрафы затухают : растет приращение новых
+        conflictInc_ /= CONFLICT_DECAY;
+        if (conflictInc_ > CONFLICT_LIMIT)
+        {
+            for (int16_t i = 0; i < idConflict_.size(); ++i)
+            {
+                idConflict_[i] /= CONFLICT_LIMIT;
+            }
+            for (int32_t i = 0; i < cellConflict_.size(); ++i)
+            {
+                cellConflict_[i] /= CONFLICT_LIMIT;
+            }
+            conflictInc_ /= CONFLICT_LIMIT;
+        }
+        
+        // Успешно завершаем
+        wasDeleted = true;
+    }
+    else
+    {
+        wasDeleted = false;
+    }
+}
+
+// (22) Вес удаления пути "id" (частые помехи, короткий путь)
+double Solver::getRipWeight(int16_t id)
+{
+    int16_t       slot   = slotById_[id];
+    const Vector* path   = pathCells_.data() + pathStart_[slot];
+    int16_t       length = pathLength_[slot];
+    
+    // Штраф пути, штрафы занятых им клеток и базовое приращение (чтобы
+    // путь без штрафов тоже мог быть выбран)
+    double conflict = idConflict_[slot] + conflictInc_;
+    
+    for (int16_t k = 0; k < length; ++k)
+    {
+        conflict += cellConflict_[map_.getPos(path[k])];
+    }
+    return conflict / max(1, length);
+}
+
+// (23) Путь "id" удален недавно?
+bool Solver::isTabu(int16_t id)
+{
+    for (int16_t i = 0; i < TABU_LENGTH; ++i)
+    {
+        if (tabu_[i] == id)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// (24) Начисляет штраф пути "id", помешавшему в клетке "pos"
+void Solver::addConflict(int16_t id, int32_t pos)
+{
+    idConflict_[slotById_[id]] += conflictInc_;
+    cellConflict_[pos]         += conflictInc_;
+}
+
+// (25) Перебирает пары и пути в глубину
+void Solver::solveBacktrack()
+{
+    // Время перебора ограничено
+    deadline_ = std::min(finish_, std::chrono::steady_clock::now() +
+                         std::chrono::milliseconds(timeLimit_));
+    nNodes_        = 0;
+    isInterrupted_ = false;
+    table_.setMemory(tableMemory_);
+    
+    // Перебор либо находит решение, либо исчерпывает все варианты
+    if (searchPoints())
+    {
+        status_ = SOLVED;
+    }
+    else
+    {
+        status_ = isInterrupted_ ? TIMEOUT : UNSOLVABLE;
+    }
+}
+
+// (26) Строит пути из оставшихся клеток (true - решено)
+bool Solver::searchPoints()
+{
+    int16_t best      = -1;
+    int16_t bestCount = 0;
+    
+    // Все нетривиальные клетки заняты
+    if (nMisPoints_ == 0)
+    {
+        return true;
+    }
+    if (isTimeUp())
+    {
+        return false;
+    }
+    saveBest(false);
+    
+    // Из этого состояния решение уже не нашлось (по другой ветви)
+    if (table_.find(hash_))
+    {
+        return false;
+    }
+    
+    // Выбираем свободную клетку с наименьшим числом достижимых пар
+    // (клетка без пар - тупик, клетка с одной парой - вынужденный ход)
+    for (int16_t slot = 0; slot < points_.size(); ++slot)
+    {
+        if (map_(points_[slot]).id == 0)
+        {
+            int16_t count = countLivePartners(slot);
+            
+            if (count == 0)
+            {
+                return false;
+            }
+            if (best < 0 || count < bestCount)
+            {
+                best      = slot;
+                bestCount = count;
+            }
+        }
+    }
+    
+    // Перебираем пары выбранной клетки и пути к ним
+    Vector  point = points_[best];
+    int32_t pos   = map_.getPos(point);
+    
+    for (int32_t k = partnerStart_[best]; k < partnerStart_[best + 1]; ++k)
+    {
+        if (map_(partners_[k]).id == 0)
+        {
+            if (searchPath(best, pos, point, 0, partners_[k]))
+            {
+                return true;
+            }
+            if (isInterrupted_)
+            {
+                return false;
+            }
+        }
+    }
+    
+    // Перебор состояния завершен без решения - оно тупиковое
+    table_.insert(hash_);
+    return false;
+}
+
+// (27) Продолжает путь номер "slot" из клетки "pos" к "target"
+bool Solver::searchPath(int16_t slot, int32_t pos, Vector cur,
+                        int16_t step, Vector target)
+{
+    const Vector  start = points_[slot];
+    const int16_t index = map_(start).index;
+    bool          found = false;
+    
+    if (isTimeUp())
+    {
+        return false;
+    }
+    
+    // Занимаем клетку и записываем ее в хранилище путей
+    occupyCell(pos, map_(start).protoId, step);
+    pathCells_[pathStart_[slot] + step] = cur;
+    pathLength_[slot] = step + 1;
+    
+    if (step == index - 1)
+    {
+        // Путь доведен до пары - строим остальные
+        if (isStatsOn_)
+        {
+            ++stats_.nBuilt[index];
+        }
+        found = searchPoints();
+    }
+    else
+    {
+        // Шагов после следующего сдвига
+        const int16_t remain = index - step - 2;
+        
+        for (int16_t dir = 0; dir < 4 && !found && !isInterrupted_; ++dir)
+        {
+            Vector  next(cur.x + SHIFT_X[dir], cur.y + SHIFT_Y[dir]);
+            int32_t nextPos = pos + map_.getShift(dir);
+            
+            if (next == target)
+            {
+                if (remain == 0)
+                {
+                    found = searchPath(slot, nextPos, next, step + 1, target);
+                }
+            }
+            else
+            if (map_.idAt(nextPos) == 0 && map_.indexAt(nextPos) == 0 &&
+                distance(next, target) - 1 <= remain)
+            {
+                found = searchPath(slot, nextPos, next, step + 1, target);
+            }
+        }
+    }
+    
+    // Неудача - освобождаем клетку (достроенный путь - удален)
+    if (!found)
+    {
+        releaseCell(pos);
+        pathLength_[slot] = step;
+        if (isStatsOn_)
+        {
+            ++stats_.nBacktracks;
+            stats_.nDeleted[index] += (step == index - 1);
+        }
+    }
+    return found;
+}
+
+// (28) Считает пары клетки номер "slot", достижимые по свободным
+int16_t Solver::countLivePartners(int16_t slot)
+{
+    const Vector  start = points_[slot];
+    const int16_t index = map_(start).index;
+    int32_t       head  = 0;
+    int32_t       tail  = 0;
+    int16_t       count = 0;
+    
+    // Новая метка вместо очистки массива меток
+    if (++nStamp_ == 0)
+    {
+        std::fill(stamp_.begin(), stamp_.end(), 0);
+        nStamp_ = 1;
+    }
+    
+    // Обход в ширину по пустым свободным клеткам не дальше "index - 1"
+    queue_[tail++] = map_.getPos(start);
+    stamp_[queue_[0]] = nStamp_;
+    depth_[queue_[0]] = 0;
+    while (head < tail)
+    {
+        int32_t pos = queue_[head++];
+        
+        for (int16_t dir = 0; dir < 4; ++dir)
+        {
+            int32_t next = pos + map_.getShift(dir);
+            
+            if (stamp_[next] != nStamp_ && map_.idAt(next) == 0)
+            {
+                if (map_.indexAt(next) == 0 && depth_[pos] + 2 < index)
+                {
+                    stamp_[next]   = nStamp_;
+                    depth_[next]   = depth_[pos] + 1;
+                    queue_[tail++] = next;
+                }
+                else
+                if (map_.indexAt(next) == index)
+                {
+                    // Пара (клетка не продолжает обход)
+                    stamp_[next] = nStamp_;
+                }
+            }
+        }
+    }
+    
+    // Пара достижима, если до нее дошел обход (четность уже проверена)
+    for (int32_t k = partnerStart_[slot]; k < partnerStart_[slot + 1]; ++k)
+    {
+        if (stamp_[map_.getPos(partners_[k])] == nStamp_)
+        {
+            ++count;
+        }
+    }
+    return count;
+}
+
+// (29) Проверяет лимит времени и флаг остановки
+bool Solver::isTimeUp()
+{
+    // Время проверяем не на каждом узле
+    if (++nNodes_ % BACKTRACK_CHECK_NUMBER == 0)
+    {
+        bool isStopped = stop_ != nullptr &&
+                         stop_->load(std::memory_order_relaxed);
+        
+        if (isStopped || std::chrono::steady_clock::now() > deadline_)
+        {
+            isInterrupted_ = true;
+        }
+    }
+    return isInterrupted_;
+}
+
+// (30) Установлен флаг остановки или истек срок "solve"?
+bool Solver::isCancelled() const
+{
+    return (stop_ != nullptr && stop_->load(std::memory_order_relaxed)) ||
+           std::chrono::steady_clock::now() > finish_;
+}
+
+// (31) Решает поле как задачу точного покрытия
+void Solver::solveExactCover()
+{
+    std::vector<int32_t> rows;
+    
+    // Время перебора (вместе с составлением каталога) ограничено
+    deadline_ = std::min(finish_, std::chrono::steady_clock::now() +
+                         std::chrono::milliseconds(timeLimit_));
+    nNodes_        = 0;
+    isInterrupted_ = false;
+    
+    // Если путей слишком много - решаем случайным блужданием
+    if (!createCatalogue())
+    {
+        cover_.clear();
+        if (isInterrupted_)
+        {
+            status_ = TIMEOUT;
+        }
+        else
+        {
+            solveRandom();
+        }
+        return;
+    }
+    
+    // Выбранные строки - пути решения, записываем их на поле
+    if (cover_.solve(rows, [this] { return isTimeUp(); }))
+    {
+        for (int32_t r = 0; r < rows.size(); ++r)
+        {
+            int16_t slot    = rowSlot_[rows[r]];
+            int16_t protoId = map_(points_[slot]).protoId;
+            int16_t length  = rowStart_[rows[r] + 1] - rowStart_[rows[r]];
+            
+            for (int16_t k = 0; k < length; ++k)
+            {
+                Vector cell = rowCells_[rowStart_[rows[r]] + k];
+                
+                occupyCell(map_.getPos(cell), protoId, k);
+                pathCells_[pathStart_[slot] + k] = cell;
+            }
+            pathLength_[slot] = length;
+            if (isStatsOn_)
+            {
+                ++stats_.nBuilt[length];
+            }
+        }
+        status_ = SOLVED;
+    }
+    else
+    {
+        status_ = cover_.wasInterrupted() ? TIMEOUT : UNSOLVABLE;
+    }
+    
+    // Каталог больше не нужен
+    cover_.clear();
+    rowCells_.clear();
+    rowStart_.clear();
+    rowSlot_.clear();
+}
+
+// (32) Составляет каталог путей всех пар (false - переполнен)
+bool Solver::createCatalogue()
+{
+    int32_t nEmpty = 0;
+    
+    // Столбцы : сначала нетривиальные клетки, затем свободные пустые
+    columnByPos_.assign(map_.getPlaneLength(), -1);
+    for (int32_t pos = 0; pos < map_.getPlaneLength(); ++pos)
+    {
+        if (map_.indexAt(pos) == 0 && map_.idAt(pos) == 0)
+        {
+            columnByPos_[pos] = points_.size() + nEmpty;
+            ++nEmpty;
+        }
+    }
+    cover_.setColumns(points_.size(), nEmpty);
+    rowCells_.clear();
+    rowSlot_.clear();
+    rowStart_.assign(1, 0);
+    isOverflow_ = false;
+    
+    // Каждую пару перечисляем один раз (от клетки с меньшим номером)
+    for (int16_t slot = 0; slot < points_.size(); ++slot)
+    {
+        Vector point = points_[slot];
+        
+        for (int32_t k = partnerStart_[slot]; k < partnerStart_[slot + 1];
+             ++k)
+        {
+            if (slotById_[map_(partners_[k]).protoId] > slot)
+            {
+                nPairPaths_ = 0;
+                enumeratePaths(slot, map_.getPos(point), point, 0,
+                               partners_[k], partnerRegions_[k]);
+                
+                if (isOverflow_ || isInterrupted_)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// (33) Перечисляет пути номер "slot" из клетки "pos" к "target"
+void Solver::enumeratePaths(int16_t slot, int32_t pos, Vector cur,
+                            int16_t step, Vector target,
+                            const Region& region)
+{
+    const int16_t index = map_(points_[slot]).index;
+    Vector*       path  = pathCells_.data() + pathStart_[slot];
+    
+    if (isOverflow_ || isTimeUp())
+    {
+        return;
+    }
+    path[step] = cur;
+    
+    // Путь дошел до пары - добавляем его в каталог
+    if (step == index - 1)
+    {
+        rowColumns_.clear();
+        rowColumns_.push_back(slot);
+        rowColumns_.push_back(slotById_[map_(target).protoId]);
+        for (int16_t k = 1; k < index - 1; ++k)
+        {
+            rowColumns_.push_back(columnByPos_[map_.getPos(path[k])]);
+        }
+        rowCells_.insert(rowCells_.end(), path, path + index);
+        rowStart_.push_back(rowCells_.size());
+        rowSlot_.push_back(slot);
+        cover_.addRow(rowColumns_);
+        
+        // Пар со слишком большим числом путей не перечисляем
+        ++nPairPaths_;
+        isOverflow_ = (nPairPaths_ > COVER_PATH_LIMIT ||
+                       cover_.getCellNumber() > COVER_CELL_LIMIT);
+        return;
+    }
+    
+    // Шагов после следующего сдвига
+    const int16_t remain = index - step - 2;
+    
+    // Клетку метим на время перебора продолжений
+    map_.idAt(pos) = map_(points_[slot]).protoId;
+    for (int16_t dir = 0; dir < 4; ++dir)
+    {
+        Vector  next(cur.x + SHIFT_X[dir], cur.y + SHIFT_Y[dir]);
+        int32_t nextPos = pos + map_.getShift(dir);
+        
+        if (next == target)
+        {
+            if (remain == 0)
+            {
+                enumeratePaths(slot, nextPos, next, step + 1, target, region);
+            }
+        }
+        else
+        if (region.inRange(next) && map_.idAt(nextPos) == 0 &&
+            map_.indexAt(nextPos) == 0 && distance(next, target) - 1 <= remain)
+        {
+            enumeratePaths(slot, nextPos, next, step + 1, target, region);
+        }
+    }
+    map_.idAt(pos) = 0;
+}
+
+// (34) Разводит пути отжигом
+void Solver::solveAnneal()
+{
+    int32_t step   = 0;
+    int16_t stage  = 0;
+    int32_t nNow   = 0;
+    int32_t nBest  = 0;
+    int32_t nCur   = 0;
+    int32_t mark   = 0;
+    bool    isDone = false;
+    
+    // Время отжига ограничено так же, как и перебора
+    deadline_ = std::min(finish_, std::chrono::steady_clock::now() +
+                         std::chrono::milliseconds(timeLimit_));
+    
+    // Начальное состояние : все, что строится без удалений
+    logSlot_.clear();
+    logStart_.clear();
+    logCells_.clear();
+    createPermutation(order_, random_);
+    for (int16_t i = 0; i < order_.size() && nMisPoints_ > 0; ++i)
+    {
+        createPath(points_[order_[i]], false);
+    }
+    nCur  = nCovered_;
+    nBest = nCur;
+    
+    // Журнал хранит изменения от лучшего состояния до текущего
+    while (nMisPoints_ > 0 && !isDone)
+    {
+        // Случайное изменение поля
+        mark = logSlot_.size();
+        changeMap();
+        nNow = nCovered_;
+        ++nSweeps_;
+        
+        // Принимаем улучшение всегда, ухудшение - с вероятностью
+        if (nNow >= nCur ||
+            random_.uniformReal() < exp((nNow - nCur) / temperature(step)))
+        {
+            nCur = nNow;
+            if (nCur > nBest)
+            {
+                nBest = nCur;
+                logSlot_.clear();
+                logStart_.clear();
+                logCells_.clear();
+            }
+        }
+        else
         {
-            // Создаем случайную перестановку нетрив. точек
-            createPermutation(points_);
+            undoLog(mark);
         }
+        ++step;
         
-        // Проходим по всем нетривиальным точкам
-        createAllPaths();
+        // Остыли - повторный нагрев от лучшего состояния
+        if (temperature(step) < ANNEAL_MIN_T)
+        {
+            if (stage < ANNEAL_STAGE_NUMBER)
+            {
+                undoLog(0);
+                nCur  = nBest;
+                step /= 5;
+                ++stage;
+            }
+            else
+            {
+                isDone = true;
+            }
+        }
         
-        // Проверям кол-во незадействованных нетрив. клеток
-        wasSolved = (getMisPathNumber() == 0);
+        // Внешняя остановка (в том числе посреди блуждания) и лимит времени
+        if (isInterrupted_ ||
+            (stop_ != nullptr && stop_->load(std::memory_order_relaxed)) ||
+            std::chrono::steady_clock::now() > deadline_)
+        {
+            isDone = true;
+        }
         
-        // Выводим символ индикации
-        if (i % INDICATOR_NUMBER == 0)
+        // Сообщаем о ходе решения
+        if (step % INDICATOR_NUMBER == 0 && progress_)
         {
-            std::cout << INDICATE_SYMBOL;
+            progress_(nSweeps_, getMisPathNumber());
         }
     }
+    
+    // Не решили - возвращаемся к лучшему состоянию
+    if (nMisPoints_ > 0)
+    {
+        undoLog(0);
+    }
+    status_ = (nMisPoints_ == 0) ? SOLVED : TIMEOUT;
 }
 
-// (9) Задает направления обхода путей (для вывода на экран)
-void Solver::setDirections()
+// (35) Удаляет несколько случайных путей и достраивает поле
+void Solver::changeMap()
 {
-    // Итератор
-    Vector iPoint;
-        
-    // Проходим по всему полю
-    for (iPoint.y = 0; iPoint.y < map_.getSizeY(); ++iPoint.y)
+    int16_t nDelete = 1 + random_.uniform(ANNEAL_DELETE_NUMBER);
+    int16_t start   = random_.uniform(points_.size());
+    
+    // Удаляем пути, начиная со случайного номера
+    for (int16_t i = 0; i < points_.size() && nDelete > 0; ++i)
     {
-        for (iPoint.x = 0; iPoint.x < map_.getSizeX(); ++iPoint.x)
+        int16_t slot = (start + i) % points_.size();
+        
+        if (pathLength_[slot] > 0)
         {
-            setDirection(iPoint);
+            recordPath(slot, false);
+            deletePath(points_[slot]);
+            --nDelete;
         }
     }
-}
-
-// (10) Освобождает выделенную память
-void Solver::clear()
-{
-    map_.clear();
-    path_.clear();
-    areas_.clear();
-    track_.clear();
-    points_.clear();
-    idArray_.clear();
-    nAreas_   = 0;
-    nId_      = 0;
-}
-
-////////// private ///////////////////////////////////////////////////////////
-
-// (1) Составляет область поиска соседей
-void Solver::createCheckingArea(Vector point, Area& area)
-{
-    area.maxX = min(map_.getSizeX() - 1, point.x + map_(point).index - 1);
-    area.minX = max(0, point.x - map_(point).index + 1);
-    area.maxY = min(map_.getSizeY() - 1, point.y + map_(point).index - 1);
-    area.minY = max(0, point.y - map_(point).index + 1);
-}
-
-// (2) Составляет рабочую область для двух точек
-void Solver::createWorkingArea(Vector p1, Vector p2, Area& area)
-{
-    // Величина расширения области
-    int16_t shift = (map_(p1).index - distance(p1, p2)) / 2;
-
-    // Продлеваем границы на величину "shift"
-    area.maxX = min(map_.getSizeX() - 1, max(p1.x + shift, p2.x + shift));
-    area.minX = max(0, min(p1.x - shift, p2.x - shift));
-    area.maxY = min(map_.getSizeY() - 1, max(p1.y + shift, p2.y + shift));
-    area.minY = max(0, min(p1.y - shift, p2.y - shift));
-}
-
-// (3) Точки являются соседями?
-bool Solver::areRelatedPoints(Vector p1, Vector p2)
-{
-    // Совпадение индексов
-    if (map_(p1).index == map_(p2).index)
+    
+    // Достраиваем свободные клетки (без удаления мешающих путей)
+    createPermutation(order_, random_);
+    for (int16_t i = 0; i < order_.size() && nMisPoints_ > 0; ++i)
     {
-        // Точки разные
-        if (p1 != p2)
+        int16_t slot = order_[i];
+        
+        if (map_(points_[slot]).id == 0)
         {
-            // Расстояние между точками
-            int16_t differ = map_(p1).index - distance(p1, p2);
-            
-            // Условие сущ-я пути между точками
-            if (differ >= 0 && differ % 2 == 0)
+            createPath(points_[slot], false);
+            if (pathLength_[slot] > 0)
             {
-                return true;
+                recordPath(slot, true);
             }
         }
     }
-    return false;
 }
 
-// (4) Создает рабочие области для "point"
-void Solver::createWorkingAreas(Vector point)
+// (36) Записывает в журнал добавление или удаление пути "slot"
+void Solver::recordPath(int16_t slot, bool wasAdded)
 {
-    Vector iPoint;
-    Area   area;
-    
-    // Создаем область поиска и начинаем отсчет заново
-    nAreas_ = 0;
-    createCheckingArea(point, area);
-    
-    // Проходим по области поиска, ищем соседей
-    for (iPoint.y = area.minY; iPoint.y <= area.maxY; ++iPoint.y)
+    logStart_.push_back(logCells_.size());
+    if (wasAdded)
+    {
+        logSlot_.push_back(slot + 1);
+    }
+    else
+    {
+        // Удаленный путь понадобится проложить заново
+        const Vector* path = pathCells_.data() + pathStart_[slot];
+        
+        logSlot_.push_back(-(slot + 1));
+        logCells_.insert(logCells_.end(), path, path + pathLength_[slot]);
+    }
+}
+
+// (37) Откатывает журнал до длины "mark"
+void Solver::undoLog(int32_t mark)
+{
+    // Отменяем записи в обратном порядке
+    while (logSlot_.size() > mark)
     {
-        for (iPoint.x = area.minX; iPoint.x <= area.maxX; ++iPoint.x)
+        int16_t code  = logSlot_.back();
+        int32_t start = logStart_.back();
+        
+        if (code > 0)
         {
-            if (areRelatedPoints(point, iPoint))
-            {
-                createWorkingArea(point, iPoint, areas_[nAreas_]);
-                ++nAreas_;
-            }
+            deletePath(points_[code - 1], true);
+        }
+        else
+        {
+            restorePath(-code - 1, logCells_.data() + start,
+                        logCells_.size() - start);
+            logCells_.resize(start);
         }
+        logSlot_.pop_back();
+        logStart_.pop_back();
     }
 }
 
-// (5) Строит (по возможности) все пути
-void Solver::createAllPaths()
+// (38) Снова прокладывает путь номер "slot" по клеткам "cells"
+void Solver::restorePath(int16_t slot, const Vector* cells, int16_t length)
 {
-    // Проходим по всем нетривиальным точкам и строим пути
-    for (int16_t i = 0; i < points_.size(); ++i)
+    Vector* path    = pathCells_.data() + pathStart_[slot];
+    int16_t protoId = map_(points_[slot]).protoId;
+    
+    for (int16_t k = 0; k < length; ++k)
     {
-        createPath(points_[i]);
+        occupyCell(map_.getPos(cells[k]), protoId, k);
+        path[k] = cells[k];
     }
+    pathLength_[slot] = length;
 }
 
-// (6) Строит путь из точки "point"
-void Solver::createPath(Vector point)
+// (39) Возвращает актуальную карту расстояний пары "pair"
+const uint8_t* Solver::getDistances(int32_t pair)
 {
-    bool wasCreated = false;
-    bool wasDeleted = true;
+    const Area& area    = partnerRegions_[pair].box;
+    bool        isFresh = (distVersion_[pair] >= 0);
     
-    // Имеет ли смысл строить путь?
-    if (map_(point).id == 0 && map_(point).index != 0)
+    // Карта устарела, если менялась хотя бы одна плитка области
+    for (int16_t ty = area.minY >> DIST_TILE_SHIFT;
+         ty <= area.maxY >> DIST_TILE_SHIFT && isFresh; ++ty)
     {
-        // Создать рабочие области, начинаем отсчет "id" заново
-        createWorkingAreas(point);
-        nId_ = 0;
-        
-        // Переставляем случайным образом рабочие области
-        createPermutation(areas_, nAreas_);
-        
-        // Пытаемся провести путь из точки "point"
-        while (!wasCreated && wasDeleted)
+        for (int16_t tx = area.minX >> DIST_TILE_SHIFT;
+             tx <= area.maxX >> DIST_TILE_SHIFT && isFresh; ++tx)
         {
-            // Перебираем соседей поочередно
-            for (int16_t i = 0; i < nAreas_ && !wasCreated; ++i)
-            {
-                createAreaPath(point, areas_[i], wasCreated);
-            }
-            
-            // Если не удалось построить, то удаляем случайный путь "id"
-            if (!wasCreated)
-            {
-                deleteRandomPath(wasDeleted);
-            }
+            isFresh = (tileStamp_[ty * nTilesX_ + tx] <= distVersion_[pair]);
         }
     }
+    
+    if (!isFresh)
+    {
+        createDistances(pair);
+    }
+    return distCells_.data() + distStart_[pair];
 }
 
-// (7) Создает новый путь из точки "point" в родственную точку
-void Solver::createAreaPath(Vector point, Area area, bool& wasCreated)
+// (40) Строит карту расстояний пары "pair" обходом в ширину
+void Solver::createDistances(int32_t pair)
 {
-    // Первичная инициализация
-    wasCreated = false;
+    const Region& region = partnerRegions_[pair];
+    const Area&   area   = region.box;
+    const Vector  target = partners_[pair];
+    const int16_t width  = area.maxX - area.minX + 1;
+    const int16_t height = area.maxY - area.minY + 1;
+    uint8_t*      dist   = distCells_.data() + distStart_[pair];
+    int32_t       head   = 0;
+    int32_t       tail   = 0;
     
-    // Имеет ли смысл строить путь?
-    if (map_(point).id == 0 && map_(point).index != 0 && area.isCorrect())
+    std::fill(dist, dist + width * height, DIST_UNREACHABLE);
+    
+    // Обход от парной клетки по свободным пустым клеткам области
+    // (нетривиальная клетка получает расстояние, но обход не продолжает)
+    queue_[tail++] = (target.y - area.minY) * width + target.x - area.minX;
+    dist[queue_[0]] = 0;
+    while (head < tail)
     {
-        bool    isFinished = false;     // Нашли путь или он не сущ-ет
-        bool    forward    = true;      // Направление последнего сдвига
-        bool    indexMatch = false;     // Совпадение индексов клеток
-        bool    stepMatch  = false;     // Дошли до конца ветви пути
-        int16_t step       = 0;         // Текущий сдвиг от начала пути
-        int32_t count      = 0;         // Счетчик циклов
-        
-        // Текущая позиция
-        Vector curPoint;
+        int32_t local = queue_[head++];
+        Vector  cur(area.minX + local % width, area.minY + local / width);
+        int32_t pos   = map_.getPos(cur);
+        uint8_t next  = min(dist[local] + 1, DIST_UNREACHABLE - 1);
         
-        for (int16_t i = 0; i < PATH_REPLAY_NUMBER && !isFinished; ++i)
+        for (int16_t dir = 0; dir < 4; ++dir)
         {
-            // Обновляем счетчик, сдвиг, текущую позицию
-            count    = 0;
-            step     = 0;
-            curPoint = point;
-            forward  = true;
-            
-            // Удаляем остатки пути
-            deletePath(point);
+            Vector near(cur.x + SHIFT_X[dir], cur.y + SHIFT_Y[dir]);
             
-            // Случайным перебором находим подходящий путь
-            while (!isFinished && count < PATH_CYCLES_NUMBER)
+            if (region.inRange(near))
             {
-                // Проверяем, в какой точке поля оказались
-                if (!area.inRange(curPoint))
-                {
-                    // Вышли за границы области
-                    --step;
-                    forward  = false;
-                    curPoint = path_[step];
-                }
-                else
-                if (map_(curPoint).id == 0)
-                {
-                    indexMatch = (map_(point).index == map_(curPoint).index);
-                    stepMatch  = (step == map_(point).index - 1);
-                    
-                    // Анализ очередной свободной точки 
-                    if (indexMatch && stepMatch)
-                    {
-                        map_(curPoint).id  = map_(point).protoId;
-                        map_(curPoint).num = step;
-                        isFinished = true;
-                        wasCreated = true;
-                    }
-                    else
-                    if (map_(curPoint).index == 0 && !stepMatch || step == 0)
-                    {
-                        map_(curPoint).id  = map_(point).protoId;
-                        map_(curPoint).num = step;
-                        path_[step]        = curPoint;
-                        
-                        track_[step].regenerate();
-                        curPoint = track_[step].getVector(curPoint);
-                        ++step;
-                        forward  = true;
-                    }
-                    else
-                    {
-                        --step;
-                        forward  = false;
-                        curPoint = path_[step];
-                    }
-                }
-                else
-                if (map_(curPoint).id == map_(point).protoId && !forward)
+                int32_t nearLocal = local + SHIFT_X[dir] + SHIFT_Y[dir] * width;
+                int32_t nearPos   = pos + map_.getShift(dir);
+                
+                if (dist[nearLocal] == DIST_UNREACHABLE &&
+                    map_.idAt(nearPos) == 0)
                 {
-                    // Произошел обратный ход
-                    if (!track_[step].haveFinished())
+                    if (map_.indexAt(nearPos) == 0)
                     {
-                        curPoint = track_[step].getVector(curPoint);
-                        ++step;
-                        forward = true;
+                        dist[nearLocal] = next;
+                        queue_[tail++]  = nearLocal;
                     }
                     else
+                    if (map_.indexAt(nearPos) > 2)
                     {
-                        map_(curPoint).id  = 0;
-                        map_(curPoint).num = 0;
-                        map_(curPoint).way = NONE;
-                        
-                        // Анализируем шаг, на котором оказались
-                        if (step > 0)
-                        {
-                            --step;
-                            forward  = false;
-                            curPoint = path_[step];
-                        }
-                        else
-                        {
-                            isFinished = true;
-                        }
+                        dist[nearLocal] = next;
                     }
                 }
-                else
-                {
-                    checkAddId(point, curPoint);
-                    --step;
-                    forward  = false;
-                    curPoint = path_[step];
-                }
-                ++count;
             }
         }
-        
-        // Если не смогли построить, то удаляем остатки пути
-        if (!isFinished)
-        {
-            deletePath(point);
-        }
     }
+    distVersion_[pair] = nChanges_;
 }
 
-// (8) Удаляет путь с началом в точке "point"
-void Solver::deletePath(Vector point)
+// (41) Отмечает изменение плитки клетки "pos"
+void Solver::touchTile(int32_t pos)
 {
-    Vector iPoint;
-    Area   area;
+    tileStamp_[tileByPos_[pos]] = ++nChanges_;
+}
+
+// (42) Добавляет "id" путей, мешающих паре "pair" точки "point"
+void Solver::collectBlockers(Vector point, int32_t pair)
+{
+    const Vector  target  = partners_[pair];
+    const Region& region  = partnerRegions_[pair];
+    const Area&   area    = region.box;
+    const int16_t width   = area.maxX - area.minX + 1;
+    const int16_t index   = map_(point).index;
+    const int16_t protoId = map_(point).protoId;
+    int32_t       head    = 0;
+    int32_t       tail    = 0;
     
-    // Создаем область удаления
-    createCheckingArea(point, area);
+    // Новая метка вместо очистки массива меток
+    if (++nStamp_ == 0)
+    {
+        std::fill(stamp_.begin(), stamp_.end(), 0);
+        nStamp_ = 1;
+    }
     
-    // Проходим по области поиска, ищем соседей
-    for (iPoint.y = area.minY; iPoint.y <= area.maxY; ++iPoint.y)
+    // Обходим клетки, куда дошло бы блуждание (с отсечением по
+    // расстоянию до пары), и запоминаем пути на их границе
+    queue_[tail++] = (point.y - area.minY) * width + point.x - area.minX;
+    stamp_[map_.getPos(point)] = nStamp_;
+    depth_[map_.getPos(point)] = 0;
+    while (head < tail)
     {
-        for (iPoint.x = area.minX; iPoint.x <= area.maxX; ++iPoint.x)
+        int32_t local = queue_[head++];
+        Vector  cur(area.minX + local % width, area.minY + local / width);
+        int32_t pos   = map_.getPos(cur);
+        
+        for (int16_t dir = 0; dir < 4; ++dir)
         {
-            // Если точка занята, то отчищаем ее
-            if (map_(iPoint).id == map_(point).protoId)
+            Vector  near(cur.x + SHIFT_X[dir], cur.y + SHIFT_Y[dir]);
+            int32_t nearPos = pos + map_.getShift(dir);
+            
+            if (region.inRange(near) && stamp_[nearPos] != nStamp_)
             {
-                map_(iPoint).id  = 0;
-                map_(iPoint).num = 0;
-                map_(iPoint).way = NONE;
+                stamp_[nearPos] = nStamp_;
+                if (map_.idAt(nearPos) != 0)
+                {
+                    checkAddId(index, protoId, nearPos);
+                }
+                else
+                if (map_.indexAt(nearPos) == 0 &&
+                    depth_[pos] + distance(near, target) <= index - 1)
+                {
+                    depth_[nearPos] = depth_[pos] + 1;
+                    queue_[tail++]  = local + SHIFT_X[dir] +
+                                      SHIFT_Y[dir] * width;
+                }
             }
         }
     }
 }
 
-// (9) Удаляет путь с номером "id"
-void Solver::deletePath(int16_t id)
+// (43) Возвращает количество непостроенных путей
+int16_t Solver::getMisPathNumber()
 {
-    if (id > 0)
-    {
-        deletePath(getPosition(id));
-    }
+    // Счетчик свободных нетривиальных клеток ведут "occupy/releaseCell"
+    return nMisPoints_ / 2;
 }
 
-// (10) Удаляет мешающий путь и добавляет его начало в стек 
-void Solver::deleteRandomPath(bool& wasDeleted)
+// (44) Запоминает состояние, если свободных клеток меньше
+void Solver::saveBest(bool isForced)
 {
-    if (nId_ > 0)
-    {
-        // Выбираем случайный мешающий путь для удаления
-        int16_t delIdNum = rand() % nId_;
-        
-        // Удаляем мешающий путь на поле
-        deletePath(idArray_[delIdNum]);
-        
-        // Убрать "id" пути из массива мешающих "id"
-        for (int16_t i = delIdNum; i < nId_ - 1; ++i)
-        {
-            idArray_[i] = idArray_[i + 1];
-        }
-        --nId_;
-        
-        // Успешно завершаем
-        wasDeleted = true;
-    }
-    else
+    // При равенстве лучше состояние с большим числом клеток под путями
+    if (!isForced && (nMisPoints_ > bestMisPoints_ ||
+                      (nMisPoints_ == bestMisPoints_ &&
+                       nCovered_ <= bestCovered_)))
     {
-        wasDeleted = false;
+        return;
     }
+    bestMap_       = map_;
+    bestCells_     = pathCells_;
+    bestLength_    = pathLength_;
+    bestMisPoints_ = nMisPoints_;
+    bestCovered_   = nCovered_;
+    bestHash_      = hash_;
 }
 
-// (11) Возвращает количество непостроенных путей
-int16_t Solver::getMisPathNumber()
+// (45) Возвращает лучшее запомненное состояние
+void Solver::restoreBest()
 {
-    int16_t nMisPaths = 0;
-    
-    // Считаем кол-во непостроенных путей из точек "points_"
-    for (int i = 0; i < points_.size(); ++i)
+    // Текущее состояние и есть лучшее
+    if (nMisPoints_ == bestMisPoints_ && nCovered_ == bestCovered_ &&
+        hash_ == bestHash_)
     {
-        if (map_(points_[i]).id == 0)
-        {
-            ++nMisPaths;
-        }
+        return;
     }
-    return nMisPaths / 2;
+    map_        = bestMap_;
+    pathCells_  = bestCells_;
+    pathLength_ = bestLength_;
+    nMisPoints_ = bestMisPoints_;
+    nCovered_   = bestCovered_;
+    hash_       = bestHash_;
+    
+    // Поле сменилось целиком - карты расстояний устарели
+    distVersion_.assign(distVersion_.size(), -1);
 }
 
-// (12) Проверяет наличие соседей точки "point"
+// (46) Проверяет наличие соседей точки "point"
 bool Solver::haveFriends(Vector point)
 {
-    Vector iPoint;
-    Area   area;
-    bool   haveFriend = false;
-    
-    // Создаем область поиска
-    createCheckingArea(point, area);
+    // Для нетривиальной клетки - готовый список пар
+    if (map_(point).index > 2)
+    {
+        int16_t slot = slotById_[map_(point).protoId];
+        return partnerStart_[slot + 1] > partnerStart_[slot];
+    }
     
-    // Проходим по области поиска, ищем соседей
-    for (iPoint.y = area.minY; iPoint.y <= area.maxY; ++iPoint.y)
+    // Пара клетки с "2" может быть только соседней клеткой
+    for (int16_t dir = 0; dir < 4; ++dir)
     {
-        for (iPoint.x = area.minX; iPoint.x <= area.maxX; ++iPoint.x)
+        Vector near(point.x + SHIFT_X[dir], point.y + SHIFT_Y[dir]);
+        
+        if (map_.inRange(near) && areRelatedPoints(point, near))
         {
-            if (areRelatedPoints(point, iPoint))
-            {
-                haveFriend = true;
-            }
+            return true;
         }
     }
-    return haveFriend;
+    return false;
 }
 
-// (13) Проверяет наличие соседей во всех клетках > 1
+// (47) Проверяет наличие соседей во всех клетках > 1
 bool Solver::isCorrectRelations()
 {
     Vector iPoint;
@@ -531,7 +2671,7 @@ bool Solver::isCorrectRelations()
     return haveRel;
 }
 
-// (14) Проверить, что непустые клетки (>= 2) образуют пары
+// (48) Проверить, что непустые клетки (>= 2) образуют пары
 bool Solver::isCorrectNumber()
 {
     bool                 isNormNum = true;
@@ -541,12 +2681,10 @@ bool Solver::isCorrectNumber()
     numbers.resize(MAX_INDEX + 1, 0);
     
     // Записываем, сколько клеток поля соотв. каждому индексу
-    for (int j = 0; j < map_.getSizeY(); ++j)
+    const int16_t* index = map_.getIndexPlane();
+    for (int32_t k = 0; k < map_.getPlaneLength(); ++k)
     {
-        for (int i = 0; i < map_.getSizeX(); ++i)
-        {
-            ++numbers[map_(i, j).index];
-        }
+        ++numbers[index[k]];
     }
     
     // Проверяем, что у каждого индекса из поля есть пара
@@ -557,67 +2695,20 @@ bool Solver::isCorrectNumber()
     return isNormNum;
 }
 
-// (15) Устанавливает направление обхода в точке "point"
-void Solver::setDirection(Vector point)
-{
-    if (map_(point).id != 0 && map_(point).index == 0)
-    {
-        bool haveL = false;
-        bool haveR = false;
-        bool haveU = false;
-        bool haveD = false;
-        
-        // Ищем предыдущую и следующую точки пути
-        findNear(point, haveL, haveR, haveU, haveD);
-        
-        // Записываем направление в точке "point"
-        map_(point).way = getDirection(haveL, haveR, haveU, haveD);
-    }
-    else
-    {
-        map_(point).way = NONE;
-    }
-}
-
-// (16) Находит предыдущую и следующую точки пути
-void Solver::findNear(Vector dot, bool& hL, bool& hR, bool& hU, bool& hD)
+// (49) Устанавливает направление обхода в клетке пути "dot"
+void Solver::setDirection(Vector prev, Vector dot, Vector next)
 {
-    bool temp1 = false;
-    bool temp2 = false;
-    bool temp3 = false;
+    // Соседние клетки пути : предыдущая и следующая
+    bool hL = (prev.x == dot.x - 1) || (next.x == dot.x - 1);
+    bool hR = (prev.x == dot.x + 1) || (next.x == dot.x + 1);
+    bool hU = (prev.y == dot.y + 1) || (next.y == dot.y + 1);
+    bool hD = (prev.y == dot.y - 1) || (next.y == dot.y - 1);
     
-    // Устанавливаем положение соседних точек пути (если есть)
-    if (map_.inRange(dot.x - 1, dot.y))
-    {
-        temp1 = map_(dot.x - 1, dot.y).id == map_(dot).id;
-        temp2 = map_(dot).num + 1 == map_(dot.x - 1, dot.y).num;
-        temp3 = map_(dot).num - 1 == map_(dot.x - 1, dot.y).num;
-        hL = temp1 && (temp2 || temp3);
-    }
-    if (map_.inRange(dot.x + 1, dot.y))
-    {
-        temp1 = map_(dot.x + 1, dot.y).id == map_(dot).id;
-        temp2 = map_(dot).num + 1 == map_(dot.x + 1, dot.y).num;
-        temp3 = map_(dot).num - 1 == map_(dot.x + 1, dot.y).num;
-        hR = temp1 && (temp2 || temp3);
-    }
-    if (map_.inRange(dot.x, dot.y + 1))
-    {
-        temp1 = map_(dot.x, dot.y + 1).id == map_(dot).id;
-        temp2 = map_(dot).num + 1 == map_(dot.x, dot.y + 1).num;
-        temp3 = map_(dot).num - 1 == map_(dot.x, dot.y + 1).num;
-        hU = temp1 && (temp2 || temp3);
-    }
-    if (map_.inRange(dot.x, dot.y - 1))
-    {
-        temp1 = map_(dot.x, dot.y - 1).id == map_(dot).id;
-        temp2 = map_(dot).num + 1 == map_(dot.x, dot.y - 1).num;
-        temp3 = map_(dot).num - 1 == map_(dot.x, dot.y - 1).num;
-        hD = temp1 && (temp2 || temp3);
-    }
+    // Записываем направление в клетке "dot"
+    map_.setWayAt(map_.getPos(dot), getDirection(hL, hR, hU, hD));
 }
 
-// (17) Возвращает направление пути в точке по ее соседям
+// (50) Возвращает направление пути в точке по ее соседям
 Direction Solver::getDirection(bool hL, bool hR, bool hU, bool hD)
 {
     // Устанавливаем направление в точке
@@ -645,7 +2736,7 @@ Direction Solver::getDirection(bool hL, bool hR, bool hU, bool hD)
     return NONE;
 }
 
-// (18) Добавляет новый "id" в массив всех "id" области
+// (51) Добавляет новый "id" в массив всех "id" области
 void Solver::addId(int16_t id)
 {
     if (id > 0)
@@ -667,43 +2758,66 @@ void Solver::addId(int16_t id)
     }
 }
 
-// (19) Добавляет "id" точки "curPoint" в список всех "id"
-void Solver::checkAddId(Vector point, Vector curPoint)
+// (52) Добавляет "id" клетки "pos" в список всех "id"
+void Solver::checkAddId(int16_t index, int16_t protoId, int32_t pos)
 {
-    // Проверяем, мешает ли "curPoint" проведению пути
-    bool b1 = (map_(curPoint).index == 0);
-    bool b2 = (map_(curPoint).index == map_(point).index);
-    bool b3 = (map_(curPoint).id != 0);
-    bool b4 = (map_(curPoint).id != map_(point).protoId);
+    // Проверяем, мешает ли клетка "pos" проведению пути из клетки
+    // со значением "index" и "id" пути "protoId"
+    bool b1 = (map_.indexAt(pos) == 0);
+    bool b2 = (map_.indexAt(pos) == index);
+    bool b3 = (map_.idAt(pos) != 0);
+    bool b4 = (map_.idAt(pos) != protoId);
     
-    // Добавляем "id" пути, если он мешает
+    // Добавляем "id" пути, если он мешает, и начисляем ему штраф
     if ((b1 || b2) && b3 && b4)
     {
-        addId(map_(curPoint).id);
+        addId(map_.idAt(pos));
+        addConflict(map_.idAt(pos), pos);
     }
 }
 
-// (20) Возвращает координаты точки с таким "protoId"
+// (53) Возвращает координаты точки с таким "protoId"
 Vector Solver::getPosition(int16_t id)
 {
-    Vector point;
-    
-    // "id" корректно задан?
-    if (id > 0 && id <= map_.getSizeX() * map_.getSizeY())
+    // "id" пути - "protoId" его начальной нетривиальной клетки
+    if (id <= 0 || id >= slotById_.size() || slotById_[id] < 0)
     {
-        --id;
-        
-        // Ищем целую часть от деления и остаток
-        while (id >= map_.getSizeX())
-        {
-            id -= map_.getSizeX();
-            ++point.y;
-        }
-        point.x = id;
+        throw err::PcsException(0);
     }
-    else
+    return points_[slotById_[id]];
+}
+
+// (54) Занимает клетку "pos" путем "id" (номер в пути - "num")
+void Solver::occupyCell(int32_t pos, int16_t id, int16_t num)
+{
+    if (map_.indexAt(pos) > 2)
     {
-        throw err::PcsException(0);
+        --nMisPoints_;
+    }
+    ++nCovered_;
+    if (!isWalking_)
+    {
+        touchTile(pos);
+    }
+    hash_ ^= zobristCell_[pos] * zobristId_[id];
+    map_.idAt(pos)  = id;
+    map_.numAt(pos) = num;
+}
+
+// (55) Освобождает клетку "pos"
+void Solver::releaseCell(int32_t pos)
+{
+    if (map_.indexAt(pos) > 2)
+    {
+        ++nMisPoints_;
+    }
+    --nCovered_;
+    if (!isWalking_)
+    {
+        touchTile(pos);
     }
-    return point;
+    hash_ ^= zobristCell_[pos] * zobristId_[map_.idAt(pos)];
+    map_.idAt(pos)  = 0;
+    map_.numAt(pos) = 0;
+    map_.setWayAt(pos, NONE);
 }
\ No newline at end of file
@@ -7,14 +7,299 @@
 
 #include "instrumentslib.h"
 #include "solvelib.h"
+#include "parallellib.h"
 #include "rwconfig.h"
+#include <chrono>
 #include <ctime>
+#include <iomanip>
+#include <algorithm>
+#include <filesystem>
 
 namespace pcs
 {
     // Команда выхода из меню
     const std::string comEscape = "escape";
     
+    // Ключи командной строки
+    const std::string keySeed    = "--seed";
+    const std::string keyThreads = "--threads";
+    const std::string keyBatch   = "--batch";
+    const std::string keyOutput  = "--output";
+    const std::string keyEngine  = "--engine";
+    const std::string keyLimit   = "--time-limit";
+    const std::string keyRestart = "--restart";
+    const std::string keyBase    = "--restart-base";
+    const std::string keyReset   = "--reset";
+    const std::string keyOrder   = "--order";
+    const std::string keyNoSplit = "--no-split";
+    const std::string keyTable   = "--table-memory";
+    const std::string keyBlocks  = "--blocks";
+    const std::string keyStats   = "--stats";
+    
+    // Названия движков решения
+    const std::string nameRandom    = "random";
+    const std::string nameBacktrack = "backtrack";
+    const std::string nameCover     = "cover";
+    const std::string nameAnneal    = "anneal";
+    
+    // Названия политик перезапуска
+    const std::string nameFixed     = "fixed";
+    const std::string nameGeometric = "geometric";
+    const std::string nameLuby      = "luby";
+    
+    // Названия порядков обхода клеток
+    const std::string nameShuffled    = "random";
+    const std::string nameConstrained = "constrained";
+    
+    // Приписка к имени файла решения в пакетном режиме
+    const std::string solvedSuffix = "_solved";
+    
+    // Параметры запуска программы
+    struct Options
+    {
+        bool     haveSeed  = false;             // Зерно задано явно
+        uint64_t seed      = 0;                 // Зерно генератора
+        int16_t  nThreads  = getCoreNumber();   // Кол-во решателей
+        Engine   engine    = RANDOM_WALK;       // Движок решения
+        int32_t  timeLimit = BACKTRACK_TIME_LIMIT;  // Лимит перебора (мс)
+        RestartPolicy policy = RESTART_LUBY;    // Политика перезапусков
+        RestartAction action = RESHUFFLE;       // Действие при перезапуске
+        int32_t  restartBase = RESTART_BASE;    // Базовый интервал
+        OrderPolicy   order  = ORDER_RANDOM;    // Порядок обхода клеток
+        bool     split     = true;              // Решать поле по частям
+        int32_t  tableMemory = TABLE_MEMORY >> 20;  // Таблица перебора (МБ)
+        bool     blocks    = false;             // Искать повторы блоков
+        std::string statsName;                  // Файл статистики (JSON)
+        
+        std::vector<std::string> batch;         // Файлы и папки пакета
+        std::string              outputDir;     // Папка для решений
+    };
+    
+    // Разбирает аргументы командной строки
+    void parseArguments(int argc, char* argv[], Options& options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string key = argv[i];
+            
+            if (key == keySeed && i + 1 < argc)
+            {
+                try
+                {
+                    options.seed     = std::stoull(argv[++i]);
+                    options.haveSeed = true;
+                }
+                catch (...)
+                {
+                    throw err::RwcException(0);
+                }
+            }
+            else
+            if (key == keyThreads && i + 1 < argc)
+            {
+                try
+                {
+                    options.nThreads = std::stoi(argv[++i]);
+                }
+                catch (...)
+                {
+                    throw err::RwcException(0);
+                }
+                if (options.nThreads < 1)
+                {
+                    throw err::RwcException(1);
+                }
+            }
+            else
+            if (key == keyBatch && i + 1 < argc)
+            {
+                // Все аргументы до следующего ключа - файлы и папки
+                while (i + 1 < argc && std::string(argv[i + 1]).find("--"))
+                {
+                    options.batch.push_back(argv[++i]);
+                }
+            }
+            else
+            if (key == keyOutput && i + 1 < argc)
+            {
+                options.outputDir = argv[++i];
+            }
+            else
+            if (key == keyEngine && i + 1 < argc)
+            {
+                std::string name = argv[++i];
+                
+                if (name == nameRandom)
+                {
+                    options.engine = RANDOM_WALK;
+                }
+                else
+                if (name == nameBacktrack)
+                {
+                    options.engine = BACKTRACK;
+                }
+                else
+                if (name == nameCover)
+                {
+                    options.engine = EXACT_COVER;
+                }
+                else
+                if (name == nameAnneal)
+                {
+                    options.engine = ANNEALING;
+                }
+                else
+                {
+                    throw err::RwcException(3);
+                }
+            }
+            else
+            if (key == keyLimit && i + 1 < argc)
+            {
+                try
+                {
+                    options.timeLimit = std::stoi(argv[++i]);
+                }
+                catch (...)
+                {
+                    throw err::RwcException(0);
+                }
+                if (options.timeLimit < 1)
+                {
+                    throw err::RwcException(1);
+                }
+            }
+            else
+            if (key == keyRestart && i + 1 < argc)
+            {
+                std::string name = argv[++i];
+                
+                if (name == nameFixed)
+                {
+                    options.policy = RESTART_FIXED;
+                }
+                else
+                if (name == nameGeometric)
+                {
+                    options.policy = RESTART_GEOMETRIC;
+                }
+                else
+                if (name == nameLuby)
+                {
+                    options.policy = RESTART_LUBY;
+                }
+                else
+                {
+                    throw err::RwcException(3);
+                }
+            }
+            else
+            if (key == keyBase && i + 1 < argc)
+            {
+                try
+                {
+                    options.restartBase = std::stoi(argv[++i]);
+                }
+                catch (...)
+                {
+                    throw err::RwcException(0);
+                }
+                if (options.restartBase < 1)
+                {
+                    throw err::RwcException(1);
+                }
+            }
+            else
+            if (key == keyReset)
+            {
+                options.action = RESET;
+            }
+            else
+            if (key == keyOrder && i + 1 < argc)
+            {
+                std::string name = argv[++i];
+                
+                if (name == nameShuffled)
+                {
+                    options.order = ORDER_RANDOM;
+                }
+                else
+                if (name == nameConstrained)
+                {
+                    options.order = ORDER_CONSTRAINED;
+                }
+                else
+                {
+                    throw err::RwcException(3);
+                }
+            }
+            else
+            if (key == keyNoSplit)
+            {
+                options.split = false;
+            }
+            else
+            if (key == keyBlocks)
+            {
+                options.blocks = true;
+            }
+            else
+            if (key == keyStats && i + 1 < argc)
+            {
+                options.statsName = argv[++i];
+            }
+            else
+            if (key == keyTable && i + 1 < argc)
+            {
+                try
+                {
+                    options.tableMemory = std::stoi(argv[++i]);
+                }
+                catch (...)
+                {
+                    throw err::RwcException(0);
+                }
+                if (options.tableMemory < 0)
+                {
+                    throw err::RwcException(1);
+                }
+            }
+            else
+            {
+                std::cerr << "Usage : solver [" << keySeed << " <number>] ";
+                std::cerr << "[" << keyThreads << " <number>]\n";
+                std::cerr << "               [" << keyBatch;
+                std::cerr << " <file or directory> ...] ";
+                std::cerr << "[" << keyOutput << " <directory>]\n";
+                std::cerr << "               [" << keyEngine << " ";
+                std::cerr << nameRandom << "|" << nameBacktrack << "|";
+                std::cerr << nameCover << "|" << nameAnneal << "] ";
+                std::cerr << "[" << keyLimit << " <msec>]\n";
+                std::cerr << "               [" << keyRestart << " ";
+                std::cerr << nameFixed << "|" << nameGeometric << "|";
+                std::cerr << nameLuby << "] ";
+                std::cerr << "[" << keyBase << " <sweeps>] ";
+                std::cerr << "[" << keyReset << "]\n";
+                std::cerr << "               [" << keyOrder << " ";
+                std::cerr << nameShuffled << "|" << nameConstrained << "] ";
+                std::cerr << "[" << keyNoSplit << "]\n";
+                std::cerr << "               [" << keyTable << " <MB>] ";
+                std::cerr << "[" << keyBlocks << "] ";
+                std::cerr << "[" << keyStats << " <file>]\n";
+                throw err::RwcException(3);
+            }
+        }
+        
+        // Пакетный режим не ищет блоки и не пишет статистику
+        if (!options.batch.empty() &&
+            (options.blocks || !options.statsName.empty()))
+        {
+            std::cerr << "Keys '" << keyBlocks << "' and '" << keyStats;
+            std::cerr << "' can not be used with '" << keyBatch << "'\n";
+            throw err::RwcException(3);
+        }
+    }
+    
     // Записывает правила пользования
     void instruction()
     {
@@ -84,6 +369,7 @@ namespace pcs
                 {
                     name[i] = fileName[i];
                 }
+                name[fileName.length()] = '\0';
                 
                 // Открываем файл
                 inf.open(name);
@@ -101,27 +387,203 @@ namespace pcs
         }
     }
     
-    // Запускает процедуру решения кроссворда
-    void run(pcs::Solver& solver, bool& wasSolved)
+    // Выводит символ индикации (обработчик хода решения)
+    void showProgress(int32_t, int16_t)
+    {
+        std::cout << INDICATE_SYMBOL;
+    }
+    
+    // Переносит настройки запуска в решатель (образец для остальных)
+    void configure(pcs::Solver& solver, const Options& options)
+    {
+        solver.setEngine(options.engine);
+        solver.setTimeLimit(options.timeLimit);
+        solver.setRestart(options.policy, options.action,
+                          options.restartBase);
+        solver.setOrder(options.order);
+        solver.setTableMemory(static_cast<size_t> (options.tableMemory) << 20);
+        solver.setStats(!options.statsName.empty());
+    }
+    
+    // Записывает статистику решения в файл "fileName" (JSON)
+    void writeStats(const std::string& fileName, const pcs::SolverStats& stats)
+    {
+        std::ofstream outf(fileName);
+        
+        if (!outf.is_open())
+        {
+            std::cout << "\nCan not open file '" << fileName << "'!\n";
+            return;
+        }
+        outf << "{\n";
+        outf << "  \"sweeps\": " << stats.nSweeps << ",\n";
+        outf << "  \"pathCalls\": " << stats.nPathCalls << ",\n";
+        outf << "  \"walkSteps\": " << stats.nWalkSteps << ",\n";
+        outf << "  \"cycleCaps\": " << stats.nCycleCaps << ",\n";
+        outf << "  \"backtracks\": " << stats.nBacktracks << ",\n";
+        outf << "  \"ripUps\": " << stats.nRipUps << ",\n";
+        outf << "  \"restarts\": " << stats.nRestarts << ",\n";
+        
+        // Пути по значению клетки (только ненулевые)
+        for (int16_t kind = 0; kind < 2; ++kind)
+        {
+            const std::vector<int64_t>& paths = kind == 0 ? stats.nBuilt :
+                                                            stats.nDeleted;
+            bool isFirst = true;
+            
+            outf << (kind == 0 ? "  \"built\": {" : "  \"deleted\": {");
+            for (int16_t index = 0; index < paths.size(); ++index)
+            {
+                if (paths[index] != 0)
+                {
+                    outf << (isFirst ? "" : ", ") << "\"" << index << "\": ";
+                    outf << paths[index];
+                    isFirst = false;
+                }
+            }
+            outf << "},\n";
+        }
+        outf << "  \"time\": {\"prepare\": " << stats.prepareTime;
+        outf << ", \"solve\": " << stats.solveTime;
+        outf << ", \"directions\": " << stats.directionTime << "}\n";
+        outf << "}\n";
+    }
+    
+    // Решает поле целиком : по частям, портфелем или одним решателем
+    void solveWhole(pcs::Solver& solver, const Options& options, uint64_t seed,
+                    pcs::Field& field, bool& wasSolved,
+                    pcs::SolveStatus& status, pcs::SolverStats& stats)
     {
-        float time1 = 0;
-        float time2 = 0;
+        pcs::Decomposer decomposer;
         
-        if (solver.isCorrectField())
+        if (options.split)
+        {
+            decomposer.split(solver);
+        }
+        if (decomposer.getPartNumber() > 1)
+        {
+            // Независимые части поля решаются отдельно
+            decomposer.setThreadNumber(options.nThreads);
+            decomposer.setSeed(seed);
+            decomposer.solve(wasSolved);
+            decomposer.getField(field);
+            status = decomposer.getStatus();
+            stats.add(decomposer.getStats());
+            std::cout << " [parts " << decomposer.getPartNumber() << "]";
+        }
+        else
+        if (options.nThreads > 1 && options.engine == RANDOM_WALK)
+        {
+            // Несколько независимых решателей на потоках
+            pcs::Portfolio portfolio;
+            
+            portfolio.setThreadNumber(options.nThreads);
+            portfolio.setSeed(seed);
+            portfolio.setPrototype(solver);
+            portfolio.setProgress(showProgress);
+            portfolio.solve(field, wasSolved);
+            portfolio.getField(field);
+            status = portfolio.getStatus();
+            stats.add(portfolio.getStats());
+            if (wasSolved)
+            {
+                std::cout << " [solver seed " << portfolio.getWinnerSeed();
+                std::cout << "]";
+            }
+        }
+        else
         {
-            // Подготовка к работе
             solver.prepare();
-            std::cout << " | ";
+            solver.solve(wasSolved);
+            status = solver.getStatus();
+            if (wasSolved)
+            {
+                solver.setDirections();
+                solver.getField(field);
+            }
+            stats.add(solver.getStats());
+            if (options.engine == BACKTRACK)
+            {
+                std::cout << " [table hits ";
+                std::cout << solver.getTableHitNumber() << ", misses ";
+                std::cout << solver.getTableMissNumber() << "]";
+            }
+        }
+    }
+    
+    // Запускает процедуру решения кроссворда (решение - в "field")
+    void run(pcs::Solver& solver, const Options& options, pcs::Field& field,
+             bool& wasSolved)
+    {
+        uint64_t         seed   = options.haveSeed ? options.seed : time(0);
+        pcs::Stamper     stamper;
+        pcs::SolveStatus status = TIMEOUT;
+        pcs::SolverStats stats;
+        
+        if (solver.isCorrectField())
+        {
+            // Зерно выводим для повтора запуска
+            std::cout << " [seed " << seed << "] | ";
+            
+            // Настройки решателя (они же - для решателей частей)
+            solver.setSeed(seed);
+            solver.setProgress(showProgress);
+            configure(solver, options);
             
             // Решаем и замеряем время
-            time1 = static_cast<float> (clock()) / CLOCKS_PER_SEC;
-            solver.solve(wasSolved);
-            time2 = static_cast<float> (clock()) / CLOCKS_PER_SEC;
+            auto time1 = std::chrono::steady_clock::now();
+            wasSolved = false;
+            if (options.blocks)
+            {
+                stamper.split(solver);
+            }
+            if (stamper.getBlockNumber() > 0)
+            {
+                // Различные блоки решаются один раз, затем - остаток
+                stamper.setThreadNumber(options.nThreads);
+                stamper.setSeed(seed);
+                stamper.solve(wasSolved);
+                stats.add(stamper.getStats());
+                if (wasSolved)
+                {
+                    stamper.getField(field);
+                    status = SOLVED;
+                    std::cout << " [blocks " << stamper.getBlockNumber();
+                    std::cout << ", copies " << stamper.getCopyNumber() << "]";
+                }
+            }
+            if (!wasSolved)
+            {
+                solveWhole(solver, options, seed, field, wasSolved, status,
+                           stats);
+            }
+            auto time2 = std::chrono::steady_clock::now();
             
             // Выписываем время работы
-            std::cout << " [" << time2 - time1 << " sec]";
+            std::cout << " [";
+            std::cout << std::chrono::duration<float>(time2 - time1).count();
+            std::cout << " sec]";
+            
+            // Статистика решения (если ее просили)
+            if (!options.statsName.empty())
+            {
+                writeStats(options.statsName, stats);
+            }
             
             // Если не получилось решить
+            if (!wasSolved && (options.engine == BACKTRACK ||
+                               options.engine == EXACT_COVER))
+            {
+                if (status == UNSOLVABLE)
+                {
+                    std::cout << "\nField has no solution!\n";
+                }
+                else
+                {
+                    std::cout << "\nTime limit is exceeded!\n";
+                }
+            }
+            else
             if (!wasSolved)
             {
                 std::cout << "\nAlgorithm steps are limited!\n";
@@ -158,6 +620,7 @@ namespace pcs
                 {
                     name[i] = fileName[i];
                 }
+                name[fileName.length()] = '\0';
                 
                 // Открываем файл
                 outf.open(name);
@@ -176,7 +639,7 @@ namespace pcs
     }
     
     // Предоставляет интерфейс и решает кроссворд
-    void solveCrossword()
+    void solveCrossword(const Options& options)
     {
         bool          wasExit   = false;
         bool          wasSolved = false;
@@ -197,7 +660,7 @@ namespace pcs
                 solver.setField(field);
                 
                 // Разводим пути по полю
-                run(solver, wasSolved);
+                run(solver, options, field, wasSolved);
                 
                 // Если удалось развести
                 if (wasSolved)
@@ -210,10 +673,6 @@ namespace pcs
                     // Если удалось открыть
                     if (!wasExit)
                     {
-                        // Устанавливаем направления обхода
-                        solver.setDirections();
-                        solver.getField(field);
-                        
                         // Записываем разведенное поле в файл
                         rwc::printf(outFile, field);
                         outFile.close();
@@ -230,14 +689,140 @@ namespace pcs
             field.clear();
         }
     }
+    
+    // Составляет список полей пакета (папки раскрываются в "*.txt")
+    void createBatch(const Options& options, std::vector<BatchTask>& tasks)
+    {
+        namespace fs = std::filesystem;
+        
+        std::vector<fs::path> files;
+        
+        // Раскрываем папки, файлы берем как есть
+        for (int i = 0; i < options.batch.size(); ++i)
+        {
+            fs::path path = options.batch[i];
+            
+            if (fs::is_directory(path))
+            {
+                std::vector<fs::path> dirFiles;
+                
+                for (const auto& entry : fs::directory_iterator(path))
+                {
+                    if (entry.is_regular_file() &&
+                        entry.path().extension() == ".txt")
+                    {
+                        dirFiles.push_back(entry.path());
+                    }
+                }
+                std::sort(dirFiles.begin(), dirFiles.end());
+                files.insert(files.end(), dirFiles.begin(), dirFiles.end());
+            }
+            else
+            {
+                files.push_back(path);
+            }
+        }
+        
+        // Имя решения : "<имя>_solved<расширение>"
+        tasks.resize(files.size());
+        for (int i = 0; i < files.size(); ++i)
+        {
+            fs::path outName = files[i].stem().string() + solvedSuffix;
+            
+            outName += files[i].extension();
+            if (!options.outputDir.empty())
+            {
+                outName = fs::path(options.outputDir) / outName;
+            }
+            else
+            {
+                outName = files[i].parent_path() / outName;
+            }
+            tasks[i].inName  = files[i].string();
+            tasks[i].outName = outName.string();
+        }
+    }
+    
+    // Выводит итоговую таблицу пакетного решения
+    void printBatch(const std::vector<BatchTask>& tasks)
+    {
+        int nSolved = 0;
+        
+        std::cout << '\n';
+        std::cout << std::left << std::setw(40) << "File";
+        std::cout << std::setw(12) << "Result";
+        std::cout << std::right << std::setw(12) << "Time (sec)";
+        std::cout << std::setw(10) << "Sweeps";
+        std::cout << std::setw(10) << "Restarts" << '\n';
+        
+        for (int i = 0; i < tasks.size(); ++i)
+        {
+            std::string result = "unsolved";
+            
+            if (!tasks[i].error.empty())
+            {
+                result = "error";
+            }
+            else
+            if (!tasks[i].isCorrect)
+            {
+                result = "incorrect";
+            }
+            else
+            if (tasks[i].wasSolved)
+            {
+                result = "solved";
+                ++nSolved;
+            }
+            
+            std::cout << std::left << std::setw(40) << tasks[i].inName << ' ';
+            std::cout << std::setw(11) << result;
+            std::cout << std::right << std::fixed << std::setprecision(3);
+            std::cout << std::setw(12) << tasks[i].time;
+            std::cout << std::setw(10) << tasks[i].sweeps;
+            std::cout << std::setw(10) << tasks[i].restarts;
+            if (!tasks[i].error.empty())
+            {
+                std::cout << "  " << tasks[i].error;
+            }
+            std::cout << '\n';
+        }
+        std::cout << std::defaultfloat << std::setprecision(6);
+        std::cout << "Solved : " << nSolved << " / " << tasks.size() << '\n';
+    }
+    
+    // Решает пакет полей на пуле потоков
+    void solveBatch(const Options& options)
+    {
+        std::vector<BatchTask> tasks;
+        pcs::Solver            proto;
+        uint64_t seed = options.haveSeed ? options.seed : time(0);
+        
+        createBatch(options, tasks);
+        std::cout << "Batch : " << tasks.size() << " field(s), ";
+        std::cout << options.nThreads << " thread(s) [seed " << seed << "]\n";
+        
+        configure(proto, options);
+        pcs::solveBatch(tasks, proto, options.nThreads, seed);
+        printBatch(tasks);
+    }
 }
 
-int main()
+int main(int argc, char* argv[])
 {
     try
     {
-        srand(time(0));
-        pcs::solveCrossword();
+        pcs::Options options;
+        
+        pcs::parseArguments(argc, argv, options);
+        if (options.batch.empty())
+        {
+            pcs::solveCrossword(options);
+        }
+        else
+        {
+            pcs::solveBatch(options);
+        }
     }
     catch (const err::Exception& ex)
     {